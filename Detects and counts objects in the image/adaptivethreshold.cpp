@@ -0,0 +1,78 @@
+#include "adaptivethreshold.h"
+#include <cmath>
+
+static const double kSauvolaK = 0.2;
+static const double kSauvolaRange = 128.0;
+static const double kNiblackK = -0.2;
+
+static double localThreshold(ThresholdMode mode, double mean, double variance)
+{
+    const double deviation = std::sqrt(std::max(0.0, variance));
+    if (mode == SauvolaThreshold) {
+        return mean * (1 + kSauvolaK * (deviation / kSauvolaRange - 1));
+    }
+    return mean + kNiblackK * deviation;
+}
+
+cv::Mat adaptiveThresholdInv(const cv::Mat& gray, ThresholdMode mode, int window)
+{
+    cv::Mat result, sums, squares;
+    adaptiveThresholdInv(gray, mode, window, result, sums, squares);
+    return result;
+}
+
+void adaptiveThresholdInv(const cv::Mat& gray, ThresholdMode mode, int window, cv::Mat& result,
+                          cv::Mat& sums, cv::Mat& squares)
+{
+    const int radius = std::max(1, window / 2);
+
+    // One extra row and column: sums(y, x) covers gray rows < y and columns < x.
+    cv::integral(gray, sums, squares, CV_64F, CV_64F);
+
+    result.create(gray.size(), CV_8U);
+    cv::parallel_for_(cv::Range(0, gray.rows), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; y++) {
+            const int y0 = std::max(0, y - radius);
+            const int y1 = std::min(gray.rows, y + radius + 1);
+            const double* sumTop = sums.ptr<double>(y0);
+            const double* sumBottom = sums.ptr<double>(y1);
+            const double* squareTop = squares.ptr<double>(y0);
+            const double* squareBottom = squares.ptr<double>(y1);
+            const uchar* in = gray.ptr<uchar>(y);
+            uchar* out = result.ptr<uchar>(y);
+
+            for (int x = 0; x < gray.cols; x++) {
+                const int x0 = std::max(0, x - radius);
+                const int x1 = std::min(gray.cols, x + radius + 1);
+                const double count = double(x1 - x0) * (y1 - y0);
+                const double sum = sumBottom[x1] - sumBottom[x0] - sumTop[x1] + sumTop[x0];
+                const double square = squareBottom[x1] - squareBottom[x0] - squareTop[x1] + squareTop[x0];
+                const double mean = sum / count;
+                out[x] = in[x] <= localThreshold(mode, mean, square / count - mean * mean) ? 255 : 0;
+            }
+        }
+    });
+}
+
+cv::Mat adaptiveThresholdInvDirect(const cv::Mat& gray, ThresholdMode mode, int window)
+{
+    const int radius = std::max(1, window / 2);
+    cv::Mat result(gray.size(), CV_8U);
+
+    for (int y = 0; y < gray.rows; y++) {
+        for (int x = 0; x < gray.cols; x++) {
+            double sum = 0, square = 0, count = 0;
+            for (int wy = std::max(0, y - radius); wy < std::min(gray.rows, y + radius + 1); wy++) {
+                const uchar* row = gray.ptr<uchar>(wy);
+                for (int wx = std::max(0, x - radius); wx < std::min(gray.cols, x + radius + 1); wx++) {
+                    sum += row[wx];
+                    square += double(row[wx]) * row[wx];
+                    count += 1;
+                }
+            }
+            const double mean = sum / count;
+            result.at<uchar>(y, x) = gray.at<uchar>(y, x) <= localThreshold(mode, mean, square / count - mean * mean) ? 255 : 0;
+        }
+    }
+    return result;
+}
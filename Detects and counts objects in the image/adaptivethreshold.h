@@ -0,0 +1,28 @@
+#ifndef ADAPTIVETHRESHOLD_H
+#define ADAPTIVETHRESHOLD_H
+
+#include <opencv2/opencv.hpp>
+
+enum ThresholdMode {
+    GlobalThreshold,
+    SauvolaThreshold,       // T = m * (1 + k * (s / 128 - 1)), k = 0.2
+    NiblackThreshold        // T = m + k * s, k = -0.2
+};
+
+// Local thresholds from the mean m and standard deviation s of a window x window
+// neighbourhood (clamped at the borders), taken from integral images of the values and
+// their squares, so every pixel costs the same whatever the window. Rows are split over
+// OpenCV's threads. Like the global threshold in the counter, pixels at or below T become
+// 255 (dark objects on a light background). gray must be CV_8U; window is made odd.
+cv::Mat adaptiveThresholdInv(const cv::Mat& gray, ThresholdMode mode, int window);
+
+// The same into result, with the integral images in sums and squares; all three are only
+// reallocated when the size changes, so a video loop keeps its buffers between frames.
+void adaptiveThresholdInv(const cv::Mat& gray, ThresholdMode mode, int window, cv::Mat& result,
+                          cv::Mat& sums, cv::Mat& squares);
+
+// The same thresholds summing every window directly; O(window^2) per pixel, for checking
+// and timing against adaptiveThresholdInv on small images.
+cv::Mat adaptiveThresholdInvDirect(const cv::Mat& gray, ThresholdMode mode, int window);
+
+#endif
@@ -0,0 +1,203 @@
+#include "benchmark.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static const unsigned char kBackground = 200;
+static const unsigned char kForeground = 50;
+
+CountBenchmark::CountBenchmark(const BenchmarkSettings& settings)
+    : settings(settings)
+{
+}
+
+// Objects are placed by rejection sampling with a gap wide enough that blur and closing
+// cannot join them; a touching pair shares one tangent point instead, which the pipeline
+// counts as one object, so those cases show how often that happens.
+SyntheticScene CountBenchmark::generate(int width, int height, int objects, bool noisy, bool touching,
+                                        unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> radius(15, 30);
+    std::uniform_real_distribution<double> angle(0, CV_PI);
+
+    SyntheticScene scene;
+    scene.image = cv::Mat(height, width, CV_8UC3, cv::Scalar::all(kBackground));
+
+    struct Placed { cv::Point center; int radius; };
+    std::vector<Placed> placed;
+    const int gap = 16;
+    auto fits = [&](const cv::Point& center, int r, const Placed* partner) {
+        if (center.x - r < 2 || center.y - r < 2 || center.x + r >= width - 2 || center.y + r >= height - 2) {
+            return false;
+        }
+        for (const Placed& other : placed) {
+            if (&other == partner) continue;
+            const double distance = cv::norm(center - other.center);
+            if (distance < r + other.radius + gap) return false;
+        }
+        return true;
+    };
+
+    std::uniform_int_distribution<int> x(0, width - 1), y(0, height - 1);
+    for (int attempt = 0; int(placed.size()) < objects && attempt < objects * 200; attempt++) {
+        const cv::Point center(x(random), y(random));
+        const int r = radius(random);
+        if (!fits(center, r, nullptr)) continue;
+        placed.push_back({ center, r });
+
+        if (touching && int(placed.size()) < objects && placed.size() % 2 == 1) {
+            const int r2 = radius(random);
+            const double direction = angle(random) * 2;
+            const cv::Point second(center.x + int(std::lround((r + r2) * std::cos(direction))),
+                                   center.y + int(std::lround((r + r2) * std::sin(direction))));
+            if (fits(second, r2, &placed.back())) {
+                placed.push_back({ second, r2 });
+            }
+        }
+    }
+
+    for (const Placed& object : placed) {
+        cv::circle(scene.image, object.center, object.radius, cv::Scalar::all(kForeground), cv::FILLED, cv::LINE_8);
+        scene.centers.push_back(object.center);
+    }
+
+    if (noisy) {
+        cv::Mat lighting(height, width, CV_16SC3);
+        for (int row = 0; row < height; row++) {
+            lighting.row(row).setTo(cv::Scalar::all(-30 + 60 * row / std::max(1, height - 1)));
+        }
+        cv::Mat noise(height, width, CV_16SC3);
+        cv::RNG(seed).fill(noise, cv::RNG::NORMAL, 0, 12);
+
+        cv::Mat image;
+        scene.image.convertTo(image, CV_16SC3);
+        image += lighting + noise;
+        image.convertTo(scene.image, CV_8UC3);
+    }
+
+    scene.name = QString("%1x%2 %3 %4").arg(width).arg(height).arg(objects)
+                     .arg(touching ? "touching" : noisy ? "noisy" : "clean");
+    return scene;
+}
+
+BenchmarkCase CountBenchmark::measure(const SyntheticScene& scene) const
+{
+    BenchmarkCase result;
+    result.name = scene.name;
+    result.width = scene.image.cols;
+    result.height = scene.image.rows;
+    result.expected = int(scene.centers.size());
+
+    std::vector<double> fullTimes;
+    CountResult counted;
+    QElapsedTimer timer;
+    for (int run = 0; run < settings.repeats; run++) {
+        ObjectCounter counter;
+        timer.start();
+        counted = counter.process(scene.image, settings.params);
+        fullTimes.push_back(timer.nsecsElapsed() / 1e6);
+    }
+    std::sort(fullTimes.begin(), fullTimes.end());
+    result.fullMs = fullTimes[fullTimes.size() / 2];
+    result.megapixelsPerSecond = result.fullMs > 0 ? scene.image.total() / 1000.0 / result.fullMs : 0;
+    result.counted = counted.count;
+
+    int found = 0;
+    for (const cv::Point& center : scene.centers) {
+        if (counted.labelIndex.at<uchar>(center) != 0) found++;
+    }
+    result.recall = scene.centers.empty() ? 1.0 : double(found) / scene.centers.size();
+
+    // Median per stage over the same number of repeats.
+    std::vector<std::vector<StageTiming>> runs;
+    for (int run = 0; run < settings.repeats; run++) {
+        runs.push_back(ObjectCounter::profileStages(scene.image, settings.params));
+    }
+    result.stages = runs.front();
+    for (size_t stage = 0; stage < result.stages.size(); stage++) {
+        std::vector<double> times;
+        for (const auto& timings : runs) {
+            times.push_back(timings[stage].milliseconds);
+        }
+        std::sort(times.begin(), times.end());
+        result.stages[stage].milliseconds = times[times.size() / 2];
+    }
+    return result;
+}
+
+bool CountBenchmark::run()
+{
+    settings.repeats = std::max(1, settings.repeats);
+    results.clear();
+
+    const cv::Size sizes[] = { cv::Size(640, 480), cv::Size(1920, 1080), cv::Size(3840, 2160) };
+    const int perMegapixel[] = { 40, 250 };
+
+    unsigned seed = settings.seed;
+    for (const cv::Size& size : sizes) {
+        for (int density : perMegapixel) {
+            const int objects = std::max(1, int(density * size.area() / 1e6));
+            for (int variant = 0; variant < 3; variant++) {
+                const SyntheticScene scene = generate(size.width, size.height, objects, variant == 1, variant == 2, seed++);
+                results.push_back(measure(scene));
+            }
+        }
+    }
+
+    QFile file(settings.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = "Could not write " + settings.outputPath;
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson());
+    return true;
+}
+
+QJsonObject CountBenchmark::toJson() const
+{
+    QJsonArray cases;
+    for (const BenchmarkCase& result : results) {
+        QJsonObject stages;
+        for (const StageTiming& stage : result.stages) {
+            stages[QString::fromStdString(stage.stage)] = stage.milliseconds;
+        }
+        cases.append(QJsonObject{
+            {"name", result.name},
+            {"width", result.width},
+            {"height", result.height},
+            {"expected", result.expected},
+            {"counted", result.counted},
+            {"countError", result.counted - result.expected},
+            {"recall", result.recall},
+            {"ms", result.fullMs},
+            {"megapixelsPerSecond", result.megapixelsPerSecond},
+            {"stagesMs", stages},
+        });
+    }
+
+    const CounterParams& params = settings.params;
+    return QJsonObject{
+        {"date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"opencv", QString(CV_VERSION)},
+        {"threads", cv::getNumThreads()},
+        {"cores", QThread::idealThreadCount()},
+        {"repeats", settings.repeats},
+        {"seed", int(settings.seed)},
+        {"params", QJsonObject{
+            {"threshold", params.thresholdValue},
+            {"blur", params.blurAmount},
+            {"minArea", params.minContourArea},
+            {"morph", params.morphKernelSize},
+            {"mode", int(params.thresholdMode)},
+            {"window", params.windowSize},
+        }},
+        {"cases", cases},
+    };
+}
@@ -0,0 +1,61 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "objectcounter.h"
+#include <QJsonObject>
+#include <QString>
+#include <vector>
+
+struct BenchmarkSettings {
+    QString outputPath = "benchmark.json";
+    CounterParams params;
+    int repeats = 3;
+    unsigned seed = 1;
+};
+
+// One generated image: dark ellipses of known number and position on a light background.
+struct SyntheticScene {
+    QString name;
+    cv::Mat image;
+    std::vector<cv::Point> centers;
+};
+
+struct BenchmarkCase {
+    QString name;
+    int width = 0;
+    int height = 0;
+    int expected = 0;
+    int counted = 0;
+    double recall = 0;          // share of true centres inside a kept object
+    double fullMs = 0;          // median of the repeats
+    double megapixelsPerSecond = 0;
+    std::vector<StageTiming> stages;
+};
+
+// Runs the counter on generated images at 0.3, 2 and 8 MP, sparse and dense, each clean,
+// noisy with uneven lighting, and with half the objects in touching pairs. Every case is
+// timed end to end through ObjectCounter::process() (new counter, so nothing is cached) and
+// stage by stage, and scored against the known objects; the results go to a JSON file so
+// runs from different builds can be compared.
+class CountBenchmark
+{
+public:
+    explicit CountBenchmark(const BenchmarkSettings& settings);
+
+    bool run();
+
+    QString errorString() const { return error; }
+    const std::vector<BenchmarkCase>& cases() const { return results; }
+
+    static SyntheticScene generate(int width, int height, int objects, bool noisy, bool touching, unsigned seed);
+
+private:
+    BenchmarkCase measure(const SyntheticScene& scene) const;
+    QJsonObject toJson() const;
+
+    BenchmarkSettings settings;
+    QString error;
+    std::vector<BenchmarkCase> results;
+};
+
+#endif
@@ -0,0 +1,397 @@
+#include "cli.h"
+#include "benchmark.h"
+#include "countbatch.h"
+#include "tiledcounter.h"
+#include "videocounter.h"
+#include "adaptivethreshold.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <cmath>
+#include <cstring>
+
+bool isHeadlessInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0 || std::strcmp(argv[i], "--tiled") == 0 ||
+            std::strcmp(argv[i], "--measure-benchmark") == 0 ||
+            std::strcmp(argv[i], "--threshold-benchmark") == 0 ||
+            std::strcmp(argv[i], "--benchmark") == 0 || std::strcmp(argv[i], "--video") == 0) return true;
+    }
+    return false;
+}
+
+// Decoding is timed apart from counting, so the report shows what the pipeline itself
+// sustains as well as the end-to-end rate.
+static int runVideo(const QString& input, const QString& eventsPath, const QString& annotatedPath,
+                    const VideoCountSettings& settings, int maxFrames)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    bool isCamera = false;
+    const int camera = input.toInt(&isCamera);
+    cv::VideoCapture capture;
+    if (isCamera) {
+        capture.open(camera);
+    } else {
+        capture.open(input.toStdString());
+    }
+    if (!capture.isOpened()) {
+        err << "Error: could not open " << input << "\n";
+        return 2;
+    }
+
+    VideoCounter counter(settings);
+    cv::VideoWriter writer;
+    cv::Mat frame, annotated;
+    qint64 countingNs = 0;
+    QElapsedTimer total, timer;
+    total.start();
+
+    while ((maxFrames <= 0 || counter.framesProcessed() < maxFrames) && capture.read(frame)) {
+        timer.start();
+        counter.processFrame(frame);
+        countingNs += timer.nsecsElapsed();
+
+        if (!annotatedPath.isEmpty()) {
+            if (!writer.isOpened()) {
+                const double fps = capture.get(cv::CAP_PROP_FPS);
+                writer.open(annotatedPath.toStdString(), cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
+                            fps > 0 ? fps : 30, frame.size());
+                if (!writer.isOpened()) {
+                    err << "Error: could not write " << annotatedPath << "\n";
+                    return 2;
+                }
+            }
+            frame.copyTo(annotated);
+            counter.annotate(annotated);
+            writer.write(annotated);
+        }
+    }
+    const qint64 totalMs = total.elapsed();
+
+    if (!eventsPath.isEmpty()) {
+        QFile file(eventsPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            err << "Error: could not write " << eventsPath << "\n";
+            return 2;
+        }
+        QTextStream csv(&file);
+        csv << "frame,track,direction,centroid_x,centroid_y\n";
+        for (const CrossingEvent& event : counter.crossings()) {
+            csv << event.frame << "," << event.trackId << "," << event.direction << ","
+                << QString::number(event.centroid.x, 'f', 1) << "," << QString::number(event.centroid.y, 'f', 1) << "\n";
+        }
+    }
+
+    const int frames = counter.framesProcessed();
+    out << counter.count() << " objects crossed the line in " << frames << " frames ("
+        << QString::number(countingNs > 0 ? frames * 1e9 / countingNs : 0, 'f', 1) << " fps counting, "
+        << QString::number(totalMs > 0 ? frames * 1000.0 / totalMs : 0, 'f', 1) << " fps with decoding)\n";
+    return 0;
+}
+
+static int runBenchmark(const BenchmarkSettings& settings)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    CountBenchmark benchmark(settings);
+    if (!benchmark.run()) {
+        err << "Error: " << benchmark.errorString() << "\n";
+        return 2;
+    }
+
+    out << "case                          expected counted recall      ms   MP/s\n";
+    for (const BenchmarkCase& result : benchmark.cases()) {
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+                   .arg(result.name, -29)
+                   .arg(result.expected, 8)
+                   .arg(result.counted, 7)
+                   .arg(QString::number(result.recall, 'f', 3), 6)
+                   .arg(QString::number(result.fullMs, 'f', 1), 7)
+                   .arg(QString::number(result.megapixelsPerSecond, 'f', 1), 6);
+    }
+    out << "Written to " << settings.outputPath << "\n";
+    return 0;
+}
+
+// Times measureObjects() against measuring contour by contour on the same objects, best of
+// several runs each, and reports how far apart the two tables are.
+static int runMeasureBenchmark(const QString& path, const CounterParams& params)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    cv::Mat image = cv::imread(path.toStdString());
+    if (image.empty()) {
+        err << "Error: could not decode " << path << "\n";
+        return 2;
+    }
+    const std::vector<std::vector<cv::Point>> contours =
+        ObjectCounter::findObjects(ObjectCounter::preprocessImage(image, params), params);
+
+    const int runs = 5;
+    double fusedMs = 1e300, perContourMs = 1e300;
+    ObjectTable fused, perContour;
+    QElapsedTimer timer;
+    for (int run = 0; run < runs; ++run) {
+        timer.start();
+        fused = measureObjects(image, labelObjects(image.size(), contours), contours);
+        fusedMs = qMin(fusedMs, timer.nsecsElapsed() / 1e6);
+
+        timer.start();
+        perContour = measureEachContour(image, contours);
+        perContourMs = qMin(perContourMs, timer.nsecsElapsed() / 1e6);
+    }
+
+    double centroidDiff = 0, colorDiff = 0;
+    for (size_t i = 0; i < fused.size(); ++i) {
+        centroidDiff = qMax(centroidDiff, std::hypot(fused.centroidX[i] - perContour.centroidX[i],
+                                                     fused.centroidY[i] - perContour.centroidY[i]));
+        colorDiff = qMax(colorDiff, std::abs(fused.meanRed[i] - perContour.meanRed[i]));
+    }
+
+    out << fused.size() << " objects, " << image.cols << "x" << image.rows << "\n"
+        << "single scan:  " << QString::number(fusedMs, 'f', 2) << " ms\n"
+        << "per contour:  " << QString::number(perContourMs, 'f', 2) << " ms ("
+        << QString::number(fusedMs > 0 ? perContourMs / fusedMs : 0, 'f', 1) << "x)\n"
+        << "largest difference: centroid " << QString::number(centroidDiff, 'f', 3) << " px, mean red "
+        << QString::number(colorDiff, 'f', 3) << "\n";
+    return 0;
+}
+
+// Times the integral-image local thresholds over window sizes from 3 to 301 px on the
+// blurred image, next to the direct window sums on a 128 x 128 crop, in ns per pixel.
+static int runThresholdBenchmark(const QString& path, const CounterParams& params)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    cv::Mat image = cv::imread(path.toStdString(), cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+        err << "Error: could not decode " << path << "\n";
+        return 2;
+    }
+    cv::Mat blurred;
+    cv::GaussianBlur(image, blurred, cv::Size(params.blurAmount * 2 + 1, params.blurAmount * 2 + 1), 0);
+    const cv::Rect cropRect((blurred.cols - qMin(128, blurred.cols)) / 2, (blurred.rows - qMin(128, blurred.rows)) / 2,
+                            qMin(128, blurred.cols), qMin(128, blurred.rows));
+    const cv::Mat crop = blurred(cropRect).clone();
+
+    out << image.cols << "x" << image.rows << ", " << cv::getNumThreads() << " threads\n"
+        << "mode     window  integral ns/px  direct ns/px  crop mismatches\n";
+
+    const int windows[] = { 3, 5, 11, 21, 51, 101, 151, 201, 251, 301 };
+    const ThresholdMode modes[] = { SauvolaThreshold, NiblackThreshold };
+    QElapsedTimer timer;
+    for (ThresholdMode mode : modes) {
+        for (int window : windows) {
+            double integralNs = 1e300;
+            for (int run = 0; run < 3; ++run) {
+                timer.start();
+                adaptiveThresholdInv(blurred, mode, window);
+                integralNs = qMin(integralNs, double(timer.nsecsElapsed()) / blurred.total());
+            }
+
+            timer.start();
+            const cv::Mat direct = adaptiveThresholdInvDirect(crop, mode, window);
+            const double directNs = double(timer.nsecsElapsed()) / crop.total();
+            const int mismatches = cv::countNonZero(direct != adaptiveThresholdInv(crop, mode, window));
+
+            out << QString("%1 %2 %3 %4 %5\n")
+                       .arg(QString(mode == SauvolaThreshold ? "sauvola" : "niblack"), -8)
+                       .arg(window, 6)
+                       .arg(QString::number(integralNs, 'f', 2), 15)
+                       .arg(QString::number(directNs, 'f', 1), 13)
+                       .arg(mismatches, 16);
+        }
+    }
+    return 0;
+}
+
+static int runTiled(const QString& path, const QString& objectsPath, const CounterParams& params, int tileSize)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    TiledCountSettings settings;
+    settings.params = params;
+    settings.tileSize = tileSize;
+
+    TiledCounter counter(settings);
+    if (!counter.run(path.toStdString())) {
+        err << "Error: " << QString::fromStdString(counter.errorString()) << "\n";
+        return 2;
+    }
+
+    if (!objectsPath.isEmpty()) {
+        QFile file(objectsPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            err << "Error: could not write " << objectsPath << "\n";
+            return 2;
+        }
+        QTextStream csv(&file);
+        csv << "object,area,centroid_x,centroid_y,x,y,width,height\n";
+        int index = 1;
+        for (const TiledObject& object : counter.objectList()) {
+            const cv::Rect& box = object.boundingBox;
+            csv << index++ << "," << object.area << "," << QString::number(object.centroid.x, 'f', 2) << ","
+                << QString::number(object.centroid.y, 'f', 2) << "," << box.x << "," << box.y << ","
+                << box.width << "," << box.height << "\n";
+        }
+    }
+
+    out << counter.count() << " objects in " << counter.tileCount() << " tiles (halo " << counter.halo()
+        << " px, about " << counter.peakBytes() / (1024 * 1024) << " MB peak"
+        << (counter.isStreaming() ? "" : ", image decoded whole") << ")\n";
+    return 0;
+}
+
+int runHeadless(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Counts objects without the GUI.");
+    parser.addHelpOption();
+
+    CounterParams defaults;
+    QCommandLineOption batchOption("batch", "Count objects in every image of a folder, in parallel.");
+    QCommandLineOption tiledOption("tiled", "Count objects in one very large image, tile by tile.");
+    QCommandLineOption inputOption(QStringList() << "i" << "input", "Input folder, or image with --tiled.", "path");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Output folder for the results, or objects CSV with --tiled.", "path");
+    QCommandLineOption thresholdOption("threshold", "Threshold (0-255).", "value",
+                                       QString::number(defaults.thresholdValue));
+    QCommandLineOption blurOption("blur", "Blur amount (1-15).", "value", QString::number(defaults.blurAmount));
+    QCommandLineOption minAreaOption("min-area", "Minimum contour area.", "value",
+                                     QString::number(defaults.minContourArea));
+    QCommandLineOption morphOption("morph", "Morph kernel size (1-10).", "value",
+                                   QString::number(defaults.morphKernelSize));
+    QCommandLineOption modeOption("mode", "Threshold mode: global, sauvola or niblack.", "mode", "global");
+    QCommandLineOption windowOption("window", "Local threshold window (3-301).", "px",
+                                    QString::number(defaults.windowSize));
+    QCommandLineOption formatOption("format", "Result format: csv or json.", "format", "csv");
+    QCommandLineOption threadsOption("threads", "Worker threads (0 = all cores).", "n", "0");
+    QCommandLineOption recursiveOption("recursive", "Include subfolders.");
+    QCommandLineOption measureBenchmarkOption("measure-benchmark",
+                                              "Time the single-scan measurements against per-contour ones.");
+    QCommandLineOption thresholdBenchmarkOption("threshold-benchmark",
+                                                "Time the local thresholds over 3-301 px windows.");
+    QCommandLineOption benchmarkOption("benchmark", "Time and score the counter on generated images.");
+    QCommandLineOption repeatsOption("repeats", "Runs per benchmark case.", "n", "3");
+    QCommandLineOption seedOption("seed", "Seed for the generated images.", "n", "1");
+    QCommandLineOption videoOption("video", "Count objects crossing a line in a video file or camera (-i 0).");
+    QCommandLineOption lineOption("line", "Counting line for --video: y=<0-1> or x=<0-1>.", "line", "y=0.5");
+    QCommandLineOption annotateOption("annotate", "Write the video with tracks drawn on it (MJPG).", "file");
+    QCommandLineOption maxFramesOption("max-frames", "Stop --video after this many frames.", "n", "0");
+    QCommandLineOption tileOption("tile", "Tile size in pixels for --tiled.", "n", "1024");
+
+    parser.addOptions({batchOption, tiledOption, measureBenchmarkOption, thresholdBenchmarkOption,
+                       benchmarkOption, videoOption, inputOption, outputOption, thresholdOption,
+                       blurOption, minAreaOption, morphOption, modeOption, windowOption, formatOption,
+                       threadsOption, recursiveOption, tileOption, repeatsOption, seedOption,
+                       lineOption, annotateOption, maxFramesOption});
+    parser.process(arguments);
+
+    CounterParams params;
+    params.thresholdValue = qBound(0, parser.value(thresholdOption).toInt(), 255);
+    params.blurAmount = qBound(1, parser.value(blurOption).toInt(), 15);
+    params.minContourArea = parser.value(minAreaOption).toDouble();
+    params.morphKernelSize = qBound(1, parser.value(morphOption).toInt(), 10);
+    params.windowSize = qBound(3, parser.value(windowOption).toInt(), 301) | 1;
+
+    const QString mode = parser.value(modeOption).toLower();
+    if (mode == "sauvola") {
+        params.thresholdMode = SauvolaThreshold;
+    } else if (mode == "niblack") {
+        params.thresholdMode = NiblackThreshold;
+    } else if (mode != "global") {
+        err << "Unknown threshold mode: " << mode << "\n";
+        return 1;
+    }
+
+    if (parser.isSet(videoOption)) {
+        if (!parser.isSet(inputOption)) {
+            err << "--input is required.\n";
+            return 1;
+        }
+        VideoCountSettings settings;
+        settings.params = params;
+        const QStringList line = parser.value(lineOption).toLower().split('=');
+        bool positionOk = false;
+        settings.line.position = line.size() == 2 ? line[1].toDouble(&positionOk) : 0;
+        if (!positionOk || (line[0] != "x" && line[0] != "y") || settings.line.position < 0 || settings.line.position > 1) {
+            err << "--line must be y=<0-1> or x=<0-1>.\n";
+            return 1;
+        }
+        settings.line.horizontal = line[0] == "y";
+        return runVideo(parser.value(inputOption), parser.value(outputOption), parser.value(annotateOption),
+                        settings, parser.value(maxFramesOption).toInt());
+    }
+
+    if (parser.isSet(benchmarkOption)) {
+        BenchmarkSettings settings;
+        settings.params = params;
+        if (parser.isSet(outputOption)) {
+            settings.outputPath = parser.value(outputOption);
+        }
+        settings.repeats = qMax(1, parser.value(repeatsOption).toInt());
+        settings.seed = parser.value(seedOption).toUInt();
+        return runBenchmark(settings);
+    }
+
+    if (parser.isSet(thresholdBenchmarkOption)) {
+        if (!parser.isSet(inputOption)) {
+            err << "--input is required.\n";
+            return 1;
+        }
+        return runThresholdBenchmark(parser.value(inputOption), params);
+    }
+
+    if (parser.isSet(measureBenchmarkOption)) {
+        if (!parser.isSet(inputOption)) {
+            err << "--input is required.\n";
+            return 1;
+        }
+        return runMeasureBenchmark(parser.value(inputOption), params);
+    }
+
+    if (parser.isSet(tiledOption)) {
+        if (!parser.isSet(inputOption)) {
+            err << "--input is required.\n";
+            return 1;
+        }
+        return runTiled(parser.value(inputOption), parser.value(outputOption), params,
+                        parser.value(tileOption).toInt());
+    }
+
+    if (!parser.isSet(inputOption) || !parser.isSet(outputOption)) {
+        err << "Both --input and --output are required.\n";
+        return 1;
+    }
+
+    BatchSettings settings;
+    settings.inputDir = parser.value(inputOption);
+    settings.outputDir = parser.value(outputOption);
+    settings.format = parser.value(formatOption).toLower();
+    settings.params = params;
+    settings.threads = qMax(0, parser.value(threadsOption).toInt());
+    settings.recursive = parser.isSet(recursiveOption);
+
+    CountBatch batch(settings);
+    if (!batch.run()) {
+        err << "Error: " << batch.errorString() << "\n";
+        return 2;
+    }
+
+    out << batch.processedCount() << "/" << batch.totalCount() << " images, " << batch.objectCount()
+        << " objects in " << batch.elapsedMs() << " ms (" << QString::number(batch.imagesPerSecond(), 'f', 1)
+        << " images/s, " << QString::number(batch.megapixelsPerSecond(), 'f', 1) << " MP/s), "
+        << batch.failedCount() << " failed\n";
+    return batch.failedCount() == 0 ? 0 : 3;
+}
@@ -0,0 +1,10 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <QStringList>
+
+// Modes that run without the GUI, started from the command line.
+bool isHeadlessInvocation(int argc, char *argv[]);
+int runHeadless(const QStringList& arguments);
+
+#endif
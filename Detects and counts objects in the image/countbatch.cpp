@@ -0,0 +1,254 @@
+#include "countbatch.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+static QString csvField(const QString& value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    return '"' + QString(value).replace("\"", "\"\"") + '"';
+}
+
+CountBatch::CountBatch(const BatchSettings& settings)
+    : settings(settings)
+    , firstJsonRecord(true)
+    , processed(0)
+    , failed(0)
+    , objects(0)
+    , pixels(0)
+    , elapsed(0)
+{
+}
+
+bool CountBatch::run()
+{
+    if (settings.format != "csv" && settings.format != "json") {
+        error = "Unknown output format: " + settings.format;
+        return false;
+    }
+    if (!QDir(settings.inputDir).exists()) {
+        error = "Input folder does not exist: " + settings.inputDir;
+        return false;
+    }
+    if (!QDir().mkpath(settings.outputDir)) {
+        error = "Could not create output folder: " + settings.outputDir;
+        return false;
+    }
+
+    QDirIterator it(settings.inputDir, QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp",
+                    QDir::Files, settings.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+    files.sort();
+
+    const QDir output(settings.outputDir);
+    countsFile.setFileName(output.filePath("counts." + settings.format));
+    if (!countsFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        error = "Could not write " + countsFile.fileName();
+        return false;
+    }
+    counts.setDevice(&countsFile);
+
+    if (settings.format == "csv") {
+        objectsFile.setFileName(output.filePath("objects.csv"));
+        if (!objectsFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            error = "Could not write " + objectsFile.fileName();
+            return false;
+        }
+        objectRows.setDevice(&objectsFile);
+        counts << "file,width,height,objects,ms,error\n";
+        objectRows << "file," << QString::fromStdString(ObjectTable::csvHeader()) << '\n';
+    } else {
+        counts << "[\n";
+    }
+
+    QThreadPool pool;
+    if (settings.threads > 0) {
+        pool.setMaxThreadCount(settings.threads);
+    }
+    settings.threads = pool.maxThreadCount();
+
+    // Parallelism is across images; OpenCV's own threads would compete for the same cores.
+    int openCvThreads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFuture<void> writer = QtConcurrent::run([this]() { writeResults(); });
+    std::vector<int> indices(files.size());
+    for (int i = 0; i < files.size(); ++i) {
+        indices[i] = i;
+    }
+    QtConcurrent::blockingMap(&pool, indices, [this](int index) { countFile(index); });
+    writer.waitForFinished();
+
+    elapsed = timer.elapsed();
+    cv::setNumThreads(openCvThreads);
+
+    if (settings.format == "json") {
+        counts << "\n]\n";
+    }
+    counts.flush();
+    objectRows.flush();
+    countsFile.close();
+    objectsFile.close();
+
+    if (!writeSummary(output.filePath("summary.json"))) {
+        error = "Could not write " + output.filePath("summary.json");
+        return false;
+    }
+    return true;
+}
+
+void CountBatch::countFile(int index)
+{
+    const QString& path = files[index];
+    ImageCount result;
+    result.file = QDir(settings.inputDir).relativeFilePath(path);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        cv::Mat image = cv::imread(path.toStdString());
+        if (image.empty()) {
+            result.error = "could not decode image";
+        } else {
+            result.width = image.cols;
+            result.height = image.rows;
+
+            cv::Mat preprocessed = ObjectCounter::preprocessImage(image, settings.params);
+            std::vector<std::vector<cv::Point>> contours = ObjectCounter::findObjects(preprocessed, settings.params);
+            result.objects = measureObjects(image, labelObjects(image.size(), contours), contours);
+            pixels += static_cast<qint64>(image.total());
+        }
+    } catch (const cv::Exception& e) {
+        result.error = QString::fromStdString(e.what());
+    } catch (const std::exception& e) {
+        result.error = QString::fromLocal8Bit(e.what());
+    }
+
+    result.milliseconds = timer.nsecsElapsed() / 1e6;
+    if (result.error.isEmpty()) {
+        ++processed;
+        objects += static_cast<qint64>(result.objects.size());
+    } else {
+        ++failed;
+    }
+    submit(index, std::move(result));
+}
+
+void CountBatch::submit(int index, ImageCount&& result)
+{
+    QMutexLocker locker(&queueMutex);
+    finished.emplace(index, std::move(result));
+    resultArrived.wakeOne();
+}
+
+// Results are written strictly in input order; those that finish early wait in the map.
+void CountBatch::writeResults()
+{
+    for (int next = 0; next < files.size(); ++next) {
+        ImageCount result;
+        {
+            QMutexLocker locker(&queueMutex);
+            while (finished.find(next) == finished.end()) {
+                resultArrived.wait(&queueMutex);
+            }
+            auto it = finished.find(next);
+            result = std::move(it->second);
+            finished.erase(it);
+        }
+        writeResult(result);
+    }
+}
+
+void CountBatch::writeResult(const ImageCount& result)
+{
+    if (settings.format == "csv") {
+        counts << csvField(result.file) << ',' << result.width << ',' << result.height << ','
+               << result.objects.size() << ',' << QString::number(result.milliseconds, 'f', 2) << ','
+               << csvField(result.error) << '\n';
+        const QString file = csvField(result.file);
+        for (size_t i = 0; i < result.objects.size(); i++) {
+            objectRows << file << ',' << QString::fromStdString(result.objects.csvRow(i)) << '\n';
+        }
+        return;
+    }
+
+    QJsonObject record;
+    record["file"] = result.file;
+    record["width"] = result.width;
+    record["height"] = result.height;
+    record["objects"] = int(result.objects.size());
+    record["ms"] = result.milliseconds;
+    if (!result.error.isEmpty()) {
+        record["error"] = result.error;
+    }
+
+    QJsonArray items;
+    const ObjectTable& table = result.objects;
+    for (size_t i = 0; i < table.size(); i++) {
+        items.append(QJsonObject{
+            {"id", int(i) + 1},
+            {"area", table.area[i]},
+            {"perimeter", table.perimeter[i]},
+            {"centroid", QJsonArray{table.centroidX[i], table.centroidY[i]}},
+            {"boundingBox", QJsonArray{table.left[i], table.top[i], table.width[i], table.height[i]}},
+            {"meanColor", QJsonArray{table.meanRed[i], table.meanGreen[i], table.meanBlue[i]}},
+            {"eccentricity", table.eccentricity[i]},
+        });
+    }
+    record["items"] = items;
+
+    if (!firstJsonRecord) {
+        counts << ",\n";
+    }
+    firstJsonRecord = false;
+    counts << QJsonDocument(record).toJson(QJsonDocument::Compact);
+}
+
+double CountBatch::imagesPerSecond() const
+{
+    return elapsed > 0 ? processed.load() * 1000.0 / elapsed : 0.0;
+}
+
+double CountBatch::megapixelsPerSecond() const
+{
+    return elapsed > 0 ? pixels.load() / 1000.0 / elapsed : 0.0;
+}
+
+bool CountBatch::writeSummary(const QString& path) const
+{
+    QJsonObject summary;
+    summary["input"] = settings.inputDir;
+    summary["output"] = settings.outputDir;
+    summary["threshold"] = settings.params.thresholdValue;
+    summary["blur"] = settings.params.blurAmount;
+    summary["minArea"] = settings.params.minContourArea;
+    summary["morphKernel"] = settings.params.morphKernelSize;
+    summary["mode"] = int(settings.params.thresholdMode);
+    summary["window"] = settings.params.windowSize;
+    summary["threads"] = settings.threads;
+    summary["images"] = files.size();
+    summary["processed"] = processed.load();
+    summary["failed"] = failed.load();
+    summary["objects"] = objects.load();
+    summary["elapsedMs"] = elapsed;
+    summary["imagesPerSecond"] = imagesPerSecond();
+    summary["megapixelsPerSecond"] = megapixelsPerSecond();
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    file.write(QJsonDocument(summary).toJson());
+    return true;
+}
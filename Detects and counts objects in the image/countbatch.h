@@ -0,0 +1,82 @@
+#ifndef COUNTBATCH_H
+#define COUNTBATCH_H
+
+#include "objectcounter.h"
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QWaitCondition>
+#include <atomic>
+#include <map>
+#include <vector>
+
+struct BatchSettings {
+    QString inputDir;
+    QString outputDir;
+    QString format = "csv";     // csv or json
+    CounterParams params;
+    int threads = 0;
+    bool recursive = false;
+};
+
+struct ImageCount {
+    QString file;
+    int width = 0;
+    int height = 0;
+    double milliseconds = 0;
+    QString error;
+    ObjectTable objects;
+};
+
+// Counts objects in every image of a folder with the GUI's preprocessImage/findObjects, so
+// the numbers match the window for the same parameters. Pool threads decode and count one
+// image each and measure them with measureObjects(); a single writer thread streams
+// finished results to disk in input order while the pool keeps working. Writes
+// counts.<format>, objects.csv (csv only) and summary.json.
+class CountBatch
+{
+public:
+    explicit CountBatch(const BatchSettings& settings);
+
+    bool run();
+
+    QString errorString() const { return error; }
+    int totalCount() const { return files.size(); }
+    int processedCount() const { return processed.load(); }
+    int failedCount() const { return failed.load(); }
+    qint64 objectCount() const { return objects.load(); }
+    qint64 elapsedMs() const { return elapsed; }
+    double imagesPerSecond() const;
+    double megapixelsPerSecond() const;
+
+private:
+    void countFile(int index);
+    void submit(int index, ImageCount&& result);
+    void writeResults();
+    void writeResult(const ImageCount& result);
+    bool writeSummary(const QString& path) const;
+
+    BatchSettings settings;
+    QString error;
+    QStringList files;
+
+    QMutex queueMutex;
+    QWaitCondition resultArrived;
+    std::map<int, ImageCount> finished;
+
+    QFile countsFile;
+    QFile objectsFile;
+    QTextStream counts;
+    QTextStream objectRows;
+    bool firstJsonRecord;
+
+    std::atomic<int> processed;
+    std::atomic<int> failed;
+    std::atomic<qint64> objects;
+    std::atomic<qint64> pixels;
+    qint64 elapsed;
+};
+
+#endif
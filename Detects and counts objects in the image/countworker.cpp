@@ -0,0 +1,51 @@
+#include "countworker.h"
+#include <QtConcurrent>
+
+CountWorker::CountWorker(QObject *parent)
+    : QObject(parent)
+    , cancelRequested(false)
+    , hasPending(false)
+{
+    connect(&watcher, &QFutureWatcher<CountResult>::finished, this, &CountWorker::jobFinished);
+}
+
+CountWorker::~CountWorker()
+{
+    cancelRequested = true;
+    watcher.waitForFinished();
+}
+
+void CountWorker::request(const cv::Mat& image, const CounterParams& params)
+{
+    if (watcher.isRunning()) {
+        pendingImage = image;
+        pendingParams = params;
+        hasPending = true;
+        cancelRequested = true;
+        return;
+    }
+    start(image, params);
+}
+
+void CountWorker::start(const cv::Mat& image, const CounterParams& params)
+{
+    cancelRequested = false;
+    watcher.setFuture(QtConcurrent::run([this, image, params]() {
+        return counter.process(image, params, &cancelRequested);
+    }));
+}
+
+void CountWorker::jobFinished()
+{
+    if (hasPending) {
+        hasPending = false;
+        start(pendingImage, pendingParams);
+        pendingImage = cv::Mat();
+        return;
+    }
+
+    const CountResult result = watcher.result();
+    if (!result.cancelled) {
+        emit resultReady(result);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef COUNTWORKER_H
+#define COUNTWORKER_H
+
+#include "objectcounter.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <atomic>
+
+// Runs ObjectCounter off the GUI thread, one job at a time. A request made while a job is
+// running replaces any earlier pending one and asks the running job to stop at its next
+// stage boundary; only the result for the newest parameters is announced.
+class CountWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CountWorker(QObject *parent = nullptr);
+    ~CountWorker();
+
+    void request(const cv::Mat& image, const CounterParams& params);
+
+signals:
+    void resultReady(const CountResult& result);
+
+private:
+    void start(const cv::Mat& image, const CounterParams& params);
+    void jobFinished();
+
+    ObjectCounter counter;
+    QFutureWatcher<CountResult> watcher;
+    std::atomic<bool> cancelRequested;
+
+    bool hasPending;
+    cv::Mat pendingImage;
+    CounterParams pendingParams;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "labellayer.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+#include <cstdio>
+
+static const int kGlyphWidth = 9;
+static const int kGlyphHeight = 14;
+
+LabelLayer::LabelLayer(const ObjectTable& objects, const QSize& imageSize)
+    : size(imageSize)
+{
+    setFlag(ItemUsesExtendedStyleOption);
+
+    centers.reserve(objects.size());
+    widths.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); i++) {
+        centers.emplace_back(objects.centroidX[i], objects.centroidY[i]);
+        widths.push_back(float(objects.width[i]));
+    }
+}
+
+QRectF LabelLayer::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), size);
+}
+
+const QPixmap& LabelLayer::digitAtlas()
+{
+    static QPixmap atlas;
+    if (atlas.isNull()) {
+        QImage image(kGlyphWidth * 10, kGlyphHeight, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QFont font;
+        font.setPixelSize(kGlyphHeight - 3);
+        font.setBold(true);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        for (int digit = 0; digit < 10; digit++) {
+            QPainterPath path;
+            path.addText(0, 0, font, QString::number(digit));
+            const QRectF bounds = path.boundingRect();
+            path.translate(digit * kGlyphWidth + (kGlyphWidth - bounds.width()) / 2 - bounds.left(),
+                           (kGlyphHeight - bounds.height()) / 2 - bounds.top());
+            painter.strokePath(path, QPen(QColor(0, 0, 0, 200), 2.5));
+            painter.fillPath(path, Qt::white);
+        }
+        atlas = QPixmap::fromImage(image);
+    }
+    return atlas;
+}
+
+void LabelLayer::drawNumber(QPainter *painter, int number, const QPointF& center)
+{
+    char digits[12];
+    const int count = std::snprintf(digits, sizeof(digits), "%d", number);
+    const QPointF origin(center.x() - count * kGlyphWidth / 2.0, center.y() - kGlyphHeight / 2.0);
+    for (int i = 0; i < count; i++) {
+        painter->drawPixmap(QPointF(origin.x() + i * kGlyphWidth, origin.y()), digitAtlas(),
+                            QRectF((digits[i] - '0') * kGlyphWidth, 0, kGlyphWidth, kGlyphHeight));
+    }
+}
+
+void LabelLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const qreal scale = option->levelOfDetailFromTransform(painter->worldTransform());
+    const QRectF exposed = option->exposedRect;
+    const QTransform toDevice = painter->worldTransform();
+
+    // Glyphs keep their pixel size whatever the zoom.
+    painter->save();
+    painter->resetTransform();
+    for (size_t i = 0; i < centers.size(); i++) {
+        const int digits = i + 1 < 10 ? 1 : int(std::log10(double(i + 1))) + 1;
+        if (widths[i] * scale < digits * kGlyphWidth || !exposed.contains(centers[i])) continue;
+        drawNumber(painter, int(i) + 1, toDevice.map(centers[i]));
+    }
+    painter->restore();
+}
+
+void LabelLayer::drawAll(QPainter *painter, const ObjectTable& objects)
+{
+    for (size_t i = 0; i < objects.size(); i++) {
+        drawNumber(painter, int(i) + 1, QPointF(objects.centroidX[i], objects.centroidY[i]));
+    }
+}
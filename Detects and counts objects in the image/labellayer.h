@@ -0,0 +1,32 @@
+#ifndef LABELLAYER_H
+#define LABELLAYER_H
+
+#include "measurements.h"
+#include <QGraphicsItem>
+#include <QPixmap>
+
+// Object numbers over the result image. Digits are blitted from a glyph atlas rendered once,
+// at a fixed on-screen size, and a number is only drawn when its object is wide enough on
+// screen to hold it and lies in the exposed area, so zooming out hides the small ones
+// instead of painting thousands of overlapping labels.
+class LabelLayer : public QGraphicsItem
+{
+public:
+    LabelLayer(const ObjectTable& objects, const QSize& imageSize);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    // Numbers at image scale, for saving; same look as on screen at 100 %.
+    static void drawAll(QPainter *painter, const ObjectTable& objects);
+
+private:
+    static const QPixmap& digitAtlas();
+    static void drawNumber(QPainter *painter, int number, const QPointF& center);
+
+    std::vector<QPointF> centers;
+    std::vector<float> widths;
+    QSize size;
+};
+
+#endif
@@ -1,8 +1,14 @@
 #include "mainwindow.h"
+#include "cli.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    if (isHeadlessInvocation(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return runHeadless(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
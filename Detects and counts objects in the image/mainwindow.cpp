@@ -1,38 +1,60 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "countworker.h"
+#include "labellayer.h"
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QDebug>
+#include <QStatusBar>
+#include <QPainter>
+#include <QWheelEvent>
+#include <cmath>
+#include <fstream>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , originalScene(new QGraphicsScene(this))
     , processedScene(new QGraphicsScene(this))
-    , thresholdValue(100)
-    , blurAmount(5)
-    , minContourArea(500.0)
-    , morphKernelSize(3)
+    , countWorker(new CountWorker(this))
 {
     ui->setupUi(this);
 
+    connect(countWorker, &CountWorker::resultReady, this, &MainWindow::showCountResult);
+
     ui->graphicsView_original->setScene(originalScene);
     ui->graphicsView_processed->setScene(processedScene);
+    ui->graphicsView_processed->setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    ui->graphicsView_processed->setDragMode(QGraphicsView::ScrollHandDrag);
+    ui->graphicsView_processed->viewport()->installEventFilter(this);
 
     ui->horizontalSlider_threshold->setRange(0, 255);
-    ui->horizontalSlider_threshold->setValue(thresholdValue);
+    ui->horizontalSlider_threshold->setValue(params.thresholdValue);
     connect(ui->horizontalSlider_threshold, &QSlider::valueChanged, this, &MainWindow::processAndCountObjects);
 
+    ui->comboBox_thresholdMode->setCurrentIndex(params.thresholdMode);
+    ui->comboBox_thresholdMode->setToolTip("Global threshold, or a local one for unevenly lit images");
+    connect(ui->comboBox_thresholdMode, &QComboBox::currentIndexChanged, this, &MainWindow::processAndCountObjects);
+
+    ui->horizontalSlider_window->setRange(3, 301);
+    ui->horizontalSlider_window->setSingleStep(2);
+    ui->horizontalSlider_window->setPageStep(20);
+    ui->horizontalSlider_window->setValue(params.windowSize);
+    ui->horizontalSlider_window->setEnabled(params.thresholdMode != GlobalThreshold);
+    ui->horizontalSlider_window->setToolTip(QString("Local threshold window: %1 px").arg(params.windowSize));
+    connect(ui->horizontalSlider_window, &QSlider::valueChanged, this, &MainWindow::processAndCountObjects);
+
     ui->horizontalSlider_blur->setRange(1, 15);
-    ui->horizontalSlider_blur->setValue(blurAmount);
+    ui->horizontalSlider_blur->setValue(params.blurAmount);
     connect(ui->horizontalSlider_blur, &QSlider::valueChanged, this, &MainWindow::processAndCountObjects);
 
     ui->horizontalSlider_minArea->setRange(100, 2000);
-    ui->horizontalSlider_minArea->setValue(minContourArea);
+    ui->horizontalSlider_minArea->setValue(params.minContourArea);
     connect(ui->horizontalSlider_minArea, &QSlider::valueChanged, this, &MainWindow::processAndCountObjects);
 
     ui->horizontalSlider_morphValue->setRange(1, 10);
-    ui->horizontalSlider_morphValue->setValue(morphKernelSize);
+    ui->horizontalSlider_morphValue->setValue(params.morphKernelSize);
     connect(ui->horizontalSlider_morphValue, &QSlider::valueChanged, this, &MainWindow::processAndCountObjects);
 
     setWindowTitle("Computer Vision 2024-2025 © Dodoc Ionuț-Daniel");
@@ -46,6 +68,18 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+// The wheel zooms the result view, so small objects' numbers can be brought into view.
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->graphicsView_processed->viewport() && event->type() == QEvent::Wheel) {
+        const QWheelEvent *wheel = static_cast<QWheelEvent*>(event);
+        const qreal factor = std::pow(1.0015, wheel->angleDelta().y());
+        ui->graphicsView_processed->scale(factor, factor);
+        return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
 void MainWindow::on_pushButton_loadImage_clicked()
 {
     QString filename = QFileDialog::getOpenFileName(this,
@@ -67,9 +101,12 @@ void MainWindow::on_pushButton_loadImage_clicked()
 
     originalScene->clear();
     originalScene->addPixmap(QPixmap::fromImage(qimg));
+    processedScene->clear();
     ui->graphicsView_original->fitInView(originalScene->sceneRect(), Qt::KeepAspectRatio);
 }
 
+// Slider drags queue many requests; CountWorker keeps only the newest, and the label
+// and preview change when its result comes back.
 void MainWindow::processAndCountObjects()
 {
     if (originalImage.empty()) {
@@ -77,71 +114,53 @@ void MainWindow::processAndCountObjects()
         return;
     }
 
-    cv::Mat preprocessed = preprocessImage(originalImage);
-
-    std::vector<std::vector<cv::Point>> contours;
-    std::vector<cv::Vec4i> hierarchy;
-
-    cv::findContours(preprocessed, contours, hierarchy,
-                     cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-    std::vector<std::vector<cv::Point>> filteredContours;
-    for (const auto& contour : contours) {
-        if (cv::contourArea(contour) >= minContourArea) {
-            filteredContours.push_back(contour);
-        }
-    }
-
-    cv::Mat result = cv::Mat::zeros(originalImage.size(), originalImage.type());
-
-    for (size_t i = 0; i < filteredContours.size(); i++) {
-        cv::Scalar color(rand() & 255, rand() & 255, rand() & 255);
-
-        cv::drawContours(result, filteredContours, i, color, cv::FILLED);
+    countWorker->request(originalImage, params);
+}
 
-        cv::Moments m = cv::moments(filteredContours[i]);
+void MainWindow::showCountResult(const CountResult& result)
+{
+    labelIndex = result.labelIndex;
+    measurements = result.objects;
+    updateProcessedImage();
 
-        cv::Point center(m.m10 / m.m00, m.m01 / m.m00);
+    ui->label_objectCount->setText(QString("Objects Detected: %1").arg(result.count));
 
-        cv::putText(result, std::to_string(i + 1), center,
-                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 2);
+    QStringList stages;
+    for (const CacheCounters& counters : result.cache) {
+        stages << QString("%1 %2/%3").arg(QString::fromStdString(counters.stage)).arg(counters.hits).arg(counters.misses);
     }
-
-
-    processedImage = result;
-    updateProcessedImage();
-
-    ui->label_objectCount->setText(QString("Objects Detected: %1").arg(filteredContours.size()));
+    statusBar()->showMessage("Cache hits/misses: " + stages.join(", "));
 }
 
-cv::Mat MainWindow::preprocessImage(const cv::Mat& inputImage)
+QImage MainWindow::labelImage() const
 {
-    cv::Mat gray, blurred, thresholded;
-
-    cv::cvtColor(inputImage, gray, cv::COLOR_BGR2GRAY);
-
-    cv::GaussianBlur(gray, blurred, cv::Size(blurAmount * 2 + 1, blurAmount * 2 + 1), 0);
-
-    cv::threshold(blurred, thresholded, thresholdValue, 255, cv::THRESH_BINARY_INV);
-
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(morphKernelSize, morphKernelSize));
-    cv::morphologyEx(thresholded, thresholded, cv::MORPH_CLOSE, kernel);
+    static QVector<QRgb> colorTable;
+    if (colorTable.isEmpty()) {
+        for (int i = 0; i < 256; i++) {
+            const cv::Vec3b color = ObjectCounter::paletteColor(i);
+            colorTable.append(qRgb(color[2], color[1], color[0]));
+        }
+    }
 
-    return thresholded;
+    QImage qimg(labelIndex.data, labelIndex.cols, labelIndex.rows,
+                labelIndex.step, QImage::Format_Indexed8);
+    qimg.setColorTable(colorTable);
+    return qimg;
 }
 
+// The label image is shown as-is with its colour table and the numbers are a separate
+// item, so nothing per object is rasterised here.
 void MainWindow::updateProcessedImage()
 {
-    if (processedImage.empty()) return;
-
-    cv::Mat rgbImage;
-    cv::cvtColor(processedImage, rgbImage, cv::COLOR_BGR2RGB);
-    QImage qimg(rgbImage.data, rgbImage.cols, rgbImage.rows,
-                rgbImage.step, QImage::Format_RGB888);
+    if (labelIndex.empty()) return;
 
+    const bool firstImage = processedScene->items().isEmpty();
     processedScene->clear();
-    processedScene->addPixmap(QPixmap::fromImage(qimg));
-    ui->graphicsView_processed->fitInView(processedScene->sceneRect(), Qt::KeepAspectRatio);
+    processedScene->addPixmap(QPixmap::fromImage(labelImage()));
+    processedScene->addItem(new LabelLayer(measurements, QSize(labelIndex.cols, labelIndex.rows)));
+    if (firstImage) {
+        ui->graphicsView_processed->fitInView(processedScene->sceneRect(), Qt::KeepAspectRatio);
+    }
 }
 
 void MainWindow::on_pushButton_processImage_clicked()
@@ -151,7 +170,7 @@ void MainWindow::on_pushButton_processImage_clicked()
 
 void MainWindow::on_pushButton_saveImage_clicked()
 {
-    if (processedImage.empty()) {
+    if (labelIndex.empty()) {
         QMessageBox::warning(this, "Error", "Process an image first");
         return;
     }
@@ -161,26 +180,75 @@ void MainWindow::on_pushButton_saveImage_clicked()
 
     if (filename.isEmpty()) return;
 
-    cv::imwrite(filename.toStdString(), processedImage);
+    QImage image = labelImage().convertToFormat(QImage::Format_RGB32);
+    QPainter painter(&image);
+    LabelLayer::drawAll(&painter, measurements);
+    painter.end();
+    image.save(filename);
+}
+
+void MainWindow::on_pushButton_exportMeasurements_clicked()
+{
+    if (measurements.size() == 0) {
+        QMessageBox::warning(this, "Error", "Process an image first");
+        return;
+    }
+
+    QStringList columns;
+    for (int c = 0; c < ObjectTable::ColumnCount; c++) {
+        columns << ObjectTable::columnName(ObjectTable::Column(c));
+    }
+    bool ok = false;
+    const QString column = QInputDialog::getItem(this, "Export Measurements", "Sort by (largest first):",
+                                                 columns, 0, false, &ok);
+    if (!ok) return;
+
+    QString filename = QFileDialog::getSaveFileName(this,
+                                                    "Export Measurements", "", "CSV Files (*.csv)");
+
+    if (filename.isEmpty()) return;
+
+    std::ofstream file(filename.toStdString());
+    if (!file) {
+        QMessageBox::warning(this, "Error", "Could not write " + filename);
+        return;
+    }
+    file << ObjectTable::csvHeader() << '\n';
+    for (int row : measurements.order(ObjectTable::Column(columns.indexOf(column)), true)) {
+        file << measurements.csvRow(row) << '\n';
+    }
 }
 
 void MainWindow::on_horizontalSlider_threshold_valueChanged(int value)
 {
-    thresholdValue = value;
+    params.thresholdValue = value;
+}
+
+void MainWindow::on_comboBox_thresholdMode_currentIndexChanged(int index)
+{
+    params.thresholdMode = ThresholdMode(index);
+    ui->horizontalSlider_threshold->setEnabled(params.thresholdMode == GlobalThreshold);
+    ui->horizontalSlider_window->setEnabled(params.thresholdMode != GlobalThreshold);
+}
+
+void MainWindow::on_horizontalSlider_window_valueChanged(int value)
+{
+    params.windowSize = value | 1;
+    ui->horizontalSlider_window->setToolTip(QString("Local threshold window: %1 px").arg(params.windowSize));
 }
 
 void MainWindow::on_horizontalSlider_blur_valueChanged(int value)
 {
-    blurAmount = value;
+    params.blurAmount = value;
 }
 
 void MainWindow::on_horizontalSlider_minArea_valueChanged(int value)
 {
-    minContourArea = value;
+    params.minContourArea = value;
 }
 
 void MainWindow::on_horizontalSlider_morphValue_valueChanged(int value)
 {
-    morphKernelSize = value;
+    params.morphKernelSize = value;
 }
 
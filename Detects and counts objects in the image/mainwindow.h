@@ -4,6 +4,9 @@
 #include <QMainWindow>
 #include <QGraphicsScene>
 #include <opencv2/opencv.hpp>
+#include "objectcounter.h"
+
+class CountWorker;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -17,32 +20,38 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
     void on_pushButton_loadImage_clicked();
     void on_pushButton_processImage_clicked();
     void on_pushButton_saveImage_clicked();
+    void on_pushButton_exportMeasurements_clicked();
     void on_horizontalSlider_threshold_valueChanged(int value);
+    void on_comboBox_thresholdMode_currentIndexChanged(int index);
+    void on_horizontalSlider_window_valueChanged(int value);
     void on_horizontalSlider_blur_valueChanged(int value);
     void on_horizontalSlider_minArea_valueChanged(int value);
     void on_horizontalSlider_morphValue_valueChanged(int value);
+    void showCountResult(const CountResult& result);
 
 private:
     void processAndCountObjects();
     void updateProcessedImage();
+    QImage labelImage() const;
     QImage cvMatToQImage(const cv::Mat& mat);
-    cv::Mat preprocessImage(const cv::Mat& inputImage);
 
     Ui::MainWindow *ui;
     QGraphicsScene *originalScene;
     QGraphicsScene *processedScene;
 
     cv::Mat originalImage;
-    cv::Mat processedImage;
+    cv::Mat labelIndex;
+    ObjectTable measurements;
 
-    int thresholdValue;
-    int blurAmount;
-    double minContourArea;
-    int morphKernelSize;
+    CounterParams params;
+    CountWorker *countWorker;
 };
 
 #endif
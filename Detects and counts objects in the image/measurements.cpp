@@ -0,0 +1,203 @@
+#include "measurements.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+// Eccentricity of the ellipse with the same second central moments (per pixel).
+static double eccentricityFromMoments(double mu20, double mu02, double mu11)
+{
+    const double mean = (mu20 + mu02) / 2;
+    const double spread = std::sqrt((mu20 - mu02) * (mu20 - mu02) / 4 + mu11 * mu11);
+    const double major = mean + spread;
+    const double minor = mean - spread;
+    return major > 0 ? std::sqrt(std::max(0.0, 1 - minor / major)) : 0;
+}
+
+void ObjectTable::resize(size_t rows)
+{
+    area.resize(rows);
+    perimeter.resize(rows);
+    centroidX.resize(rows);
+    centroidY.resize(rows);
+    left.resize(rows);
+    top.resize(rows);
+    width.resize(rows);
+    height.resize(rows);
+    meanRed.resize(rows);
+    meanGreen.resize(rows);
+    meanBlue.resize(rows);
+    eccentricity.resize(rows);
+}
+
+double ObjectTable::value(Column column, size_t row) const
+{
+    switch (column) {
+    case Area: return area[row];
+    case Perimeter: return perimeter[row];
+    case CentroidX: return centroidX[row];
+    case CentroidY: return centroidY[row];
+    case Left: return left[row];
+    case Top: return top[row];
+    case Width: return width[row];
+    case Height: return height[row];
+    case MeanRed: return meanRed[row];
+    case MeanGreen: return meanGreen[row];
+    case MeanBlue: return meanBlue[row];
+    case Eccentricity: return eccentricity[row];
+    default: return 0;
+    }
+}
+
+const char* ObjectTable::columnName(Column column)
+{
+    static const char* names[ColumnCount] = {
+        "area", "perimeter", "centroid_x", "centroid_y", "x", "y", "width", "height",
+        "mean_red", "mean_green", "mean_blue", "eccentricity"
+    };
+    return column >= 0 && column < ColumnCount ? names[column] : "";
+}
+
+std::vector<int> ObjectTable::order(Column column, bool descending) const
+{
+    std::vector<double> keys(size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i] = value(column, i);
+    }
+
+    std::vector<int> rows(size());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [&keys, descending](int a, int b) {
+        return descending ? keys[a] > keys[b] : keys[a] < keys[b];
+    });
+    return rows;
+}
+
+std::string ObjectTable::csvHeader()
+{
+    std::string header = "object";
+    for (int c = 0; c < ColumnCount; c++) {
+        header += ',';
+        header += columnName(Column(c));
+    }
+    return header;
+}
+
+std::string ObjectTable::csvRow(size_t row) const
+{
+    char line[384];
+    std::snprintf(line, sizeof(line), "%zu,%.0f,%.2f,%.2f,%.2f,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.4f",
+                  row + 1, area[row], perimeter[row], centroidX[row], centroidY[row], left[row], top[row],
+                  width[row], height[row], meanRed[row], meanGreen[row], meanBlue[row], eccentricity[row]);
+    return line;
+}
+
+cv::Mat labelObjects(const cv::Size& size, const std::vector<std::vector<cv::Point>>& contours)
+{
+    cv::Mat labels = cv::Mat::zeros(size, CV_32S);
+    for (int i = 0; i < int(contours.size()); i++) {
+        cv::drawContours(labels, contours, i, cv::Scalar(i + 1), cv::FILLED);
+    }
+    return labels;
+}
+
+ObjectTable measureObjects(const cv::Mat& image, const cv::Mat& labels,
+                           const std::vector<std::vector<cv::Point>>& contours)
+{
+    const int count = int(contours.size());
+    ObjectTable table;
+    table.resize(count);
+    if (count == 0) return table;
+
+    // Raw sums per label, indexed by label so background (0) needs no branch in the scan.
+    struct Sums {
+        double n = 0, x = 0, y = 0, xx = 0, yy = 0, xy = 0, b = 0, g = 0, r = 0;
+        int minX = INT_MAX, minY = INT_MAX, maxX = -1, maxY = -1;
+    };
+    std::vector<Sums> sums(count + 1);
+
+    const int channels = image.channels();
+    for (int y = 0; y < labels.rows; y++) {
+        const int* label = labels.ptr<int>(y);
+        const uchar* pixel = image.ptr<uchar>(y);
+        for (int x = 0; x < labels.cols; x++, pixel += channels) {
+            if (label[x] == 0) continue;
+
+            Sums& s = sums[label[x]];
+            s.n += 1;
+            s.x += x;
+            s.y += y;
+            s.xx += double(x) * x;
+            s.yy += double(y) * y;
+            s.xy += double(x) * y;
+            if (channels >= 3) {
+                s.b += pixel[0];
+                s.g += pixel[1];
+                s.r += pixel[2];
+            } else {
+                s.b += pixel[0];
+                s.g += pixel[0];
+                s.r += pixel[0];
+            }
+            s.minX = std::min(s.minX, x);
+            s.maxX = std::max(s.maxX, x);
+            s.minY = std::min(s.minY, y);
+            s.maxY = std::max(s.maxY, y);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        const Sums& s = sums[i + 1];
+        table.perimeter[i] = cv::arcLength(contours[i], true);
+        if (s.n == 0) continue;
+
+        const double cx = s.x / s.n;
+        const double cy = s.y / s.n;
+        table.area[i] = s.n;
+        table.centroidX[i] = cx;
+        table.centroidY[i] = cy;
+        table.left[i] = s.minX;
+        table.top[i] = s.minY;
+        table.width[i] = s.maxX - s.minX + 1;
+        table.height[i] = s.maxY - s.minY + 1;
+        table.meanBlue[i] = s.b / s.n;
+        table.meanGreen[i] = s.g / s.n;
+        table.meanRed[i] = s.r / s.n;
+        table.eccentricity[i] = eccentricityFromMoments(s.xx / s.n - cx * cx, s.yy / s.n - cy * cy,
+                                                        s.xy / s.n - cx * cy);
+    }
+    return table;
+}
+
+ObjectTable measureEachContour(const cv::Mat& image, const std::vector<std::vector<cv::Point>>& contours)
+{
+    const int count = int(contours.size());
+    ObjectTable table;
+    table.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        const cv::Rect box = cv::boundingRect(contours[i]);
+        cv::Mat mask = cv::Mat::zeros(box.size(), CV_8U);
+        cv::drawContours(mask, contours, i, cv::Scalar(255), cv::FILLED, cv::LINE_8, cv::noArray(), INT_MAX,
+                         -box.tl());
+
+        const cv::Moments m = cv::moments(mask, true);
+        const cv::Scalar mean = cv::mean(image(box), mask);
+        if (m.m00 == 0) continue;
+
+        table.area[i] = m.m00;
+        table.perimeter[i] = cv::arcLength(contours[i], true);
+        table.centroidX[i] = box.x + m.m10 / m.m00;
+        table.centroidY[i] = box.y + m.m01 / m.m00;
+        table.left[i] = box.x;
+        table.top[i] = box.y;
+        table.width[i] = box.width;
+        table.height[i] = box.height;
+        table.meanBlue[i] = mean[0];
+        table.meanGreen[i] = image.channels() >= 3 ? mean[1] : mean[0];
+        table.meanRed[i] = image.channels() >= 3 ? mean[2] : mean[0];
+        table.eccentricity[i] = eccentricityFromMoments(m.mu20 / m.m00, m.mu02 / m.m00, m.mu11 / m.m00);
+    }
+    return table;
+}
@@ -0,0 +1,243 @@
+#include "objectcounter.h"
+#include <cmath>
+
+static bool isCancelled(const std::atomic<bool>* cancel)
+{
+    return cancel && cancel->load();
+}
+
+// The stages write into the caller's Mat, so a buffer of the right size is reused.
+static void toGray(const cv::Mat& inputImage, cv::Mat& gray)
+{
+    cv::cvtColor(inputImage, gray, cv::COLOR_BGR2GRAY);
+}
+
+static void blurGray(const cv::Mat& gray, int blurAmount, cv::Mat& blurred)
+{
+    cv::GaussianBlur(gray, blurred, cv::Size(blurAmount * 2 + 1, blurAmount * 2 + 1), 0);
+}
+
+static void thresholdBlurred(const cv::Mat& blurred, const CounterParams& params, cv::Mat& thresholded,
+                             cv::Mat& sums, cv::Mat& squares)
+{
+    if (params.thresholdMode != GlobalThreshold) {
+        adaptiveThresholdInv(blurred, params.thresholdMode, params.windowSize, thresholded, sums, squares);
+        return;
+    }
+
+    cv::threshold(blurred, thresholded, params.thresholdValue, 255, cv::THRESH_BINARY_INV);
+}
+
+// The threshold stage's cache key: the value for the global mode, mode and window otherwise.
+static int thresholdKey(const CounterParams& params)
+{
+    if (params.thresholdMode == GlobalThreshold) return params.thresholdValue;
+    return (int(params.thresholdMode) << 16) | params.windowSize;
+}
+
+static void closeMask(const cv::Mat& thresholded, int morphKernelSize, cv::Mat& closed)
+{
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(morphKernelSize, morphKernelSize));
+    cv::morphologyEx(thresholded, closed, cv::MORPH_CLOSE, kernel);
+}
+
+static std::vector<std::vector<cv::Point>> externalContours(const cv::Mat& preprocessed)
+{
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+
+    cv::findContours(preprocessed, contours, hierarchy,
+                     cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    return contours;
+}
+
+// Hues a golden-ratio step apart, so consecutive labels never look alike.
+cv::Vec3b ObjectCounter::paletteColor(int index)
+{
+    if (index == 0) return cv::Vec3b(0, 0, 0);
+
+    const double hue = std::fmod(index * 0.618033988749895, 1.0) * 6.0;
+    const double saturation = index % 2 ? 0.85 : 0.65;
+    const double value = index % 3 ? 0.95 : 0.8;
+
+    const int sector = int(hue);
+    const double f = hue - sector;
+    const double p = value * (1 - saturation);
+    const double q = value * (1 - saturation * f);
+    const double t = value * (1 - saturation * (1 - f));
+    double r, g, b;
+    switch (sector) {
+    case 0: r = value; g = t; b = p; break;
+    case 1: r = q; g = value; b = p; break;
+    case 2: r = p; g = value; b = t; break;
+    case 3: r = p; g = q; b = value; break;
+    case 4: r = t; g = p; b = value; break;
+    default: r = value; g = p; b = q; break;
+    }
+    return cv::Vec3b(cv::saturate_cast<uchar>(b * 255), cv::saturate_cast<uchar>(g * 255),
+                     cv::saturate_cast<uchar>(r * 255));
+}
+
+cv::Mat ObjectCounter::paletteIndex(const cv::Mat& labels)
+{
+    cv::Mat index(labels.size(), CV_8U);
+    cv::parallel_for_(cv::Range(0, labels.rows), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; y++) {
+            const int* label = labels.ptr<int>(y);
+            uchar* out = index.ptr<uchar>(y);
+            for (int x = 0; x < labels.cols; x++) {
+                out[x] = label[x] == 0 ? 0 : uchar((label[x] - 1) % 255 + 1);
+            }
+        }
+    });
+    return index;
+}
+
+cv::Mat ObjectCounter::preprocessImage(const cv::Mat& inputImage, const CounterParams& params)
+{
+    PreprocessBuffers buffers;
+    return preprocessImage(inputImage, params, buffers);
+}
+
+const cv::Mat& ObjectCounter::preprocessImage(const cv::Mat& inputImage, const CounterParams& params,
+                                              PreprocessBuffers& buffers)
+{
+    toGray(inputImage, buffers.gray);
+    blurGray(buffers.gray, params.blurAmount, buffers.blurred);
+    thresholdBlurred(buffers.blurred, params, buffers.thresholded, buffers.sums, buffers.squares);
+    closeMask(buffers.thresholded, params.morphKernelSize, buffers.closed);
+    return buffers.closed;
+}
+
+std::vector<std::vector<cv::Point>> ObjectCounter::findObjects(const cv::Mat& preprocessed, const CounterParams& params)
+{
+    std::vector<std::vector<cv::Point>> filteredContours;
+    for (const auto& contour : externalContours(preprocessed)) {
+        if (cv::contourArea(contour) >= params.minContourArea) {
+            filteredContours.push_back(contour);
+        }
+    }
+    return filteredContours;
+}
+
+std::vector<StageTiming> ObjectCounter::profileStages(const cv::Mat& inputImage, const CounterParams& params)
+{
+    std::vector<StageTiming> timings;
+    int64 start = cv::getTickCount();
+    auto lap = [&](const char* stage) {
+        const int64 now = cv::getTickCount();
+        timings.push_back({ stage, (now - start) * 1000.0 / cv::getTickFrequency() });
+        start = now;
+    };
+
+    PreprocessBuffers buffers;
+    toGray(inputImage, buffers.gray);
+    lap("gray");
+    blurGray(buffers.gray, params.blurAmount, buffers.blurred);
+    lap("blur");
+    thresholdBlurred(buffers.blurred, params, buffers.thresholded, buffers.sums, buffers.squares);
+    lap("threshold");
+    closeMask(buffers.thresholded, params.morphKernelSize, buffers.closed);
+    lap("morphology");
+    const std::vector<std::vector<cv::Point>> contours = findObjects(buffers.closed, params);
+    lap("contours");
+    const cv::Mat labels = labelObjects(inputImage.size(), contours);
+    lap("labels");
+    measureObjects(inputImage, labels, contours);
+    lap("measure");
+    paletteIndex(labels);
+    lap("palette");
+    return timings;
+}
+
+// Counts a hit when the stage was last built from the same parameter and upstream
+// version; otherwise counts a miss and stamps the stage with a new version, and the
+// caller rebuilds its output.
+bool ObjectCounter::isCurrent(Stage stage, int parameter, std::uint64_t upstream)
+{
+    CachedStage& cached = stages[stage];
+    if (cached.version != 0 && cached.parameter == parameter && cached.upstream == upstream) {
+        ++counters[stage].hits;
+        return true;
+    }
+
+    ++counters[stage].misses;
+    cached.parameter = parameter;
+    cached.upstream = upstream;
+    cached.version = ++nextVersion;
+    return false;
+}
+
+CountResult ObjectCounter::process(const cv::Mat& inputImage, const CounterParams& params,
+                                   const std::atomic<bool>* cancel)
+{
+    CountResult counted;
+
+    // Holding on to the input keeps its buffer alive, so a different image can never
+    // arrive at the same address.
+    if (cachedInput.data != inputImage.data || cachedInput.size() != inputImage.size() ||
+        cachedInput.type() != inputImage.type()) {
+        clearCache();
+        cachedInput = inputImage;
+        inputVersion = ++nextVersion;
+    }
+
+    if (!isCurrent(GrayStage, 0, inputVersion)) {
+        toGray(inputImage, stages[GrayStage].output);
+    }
+    if (!isCurrent(BlurStage, params.blurAmount, stages[GrayStage].version)) {
+        blurGray(stages[GrayStage].output, params.blurAmount, stages[BlurStage].output);
+    }
+    if (!isCurrent(ThresholdStage, thresholdKey(params), stages[BlurStage].version)) {
+        thresholdBlurred(stages[BlurStage].output, params, stages[ThresholdStage].output, integralSums,
+                         integralSquares);
+    }
+    if (!isCurrent(MorphologyStage, params.morphKernelSize, stages[ThresholdStage].version)) {
+        closeMask(stages[ThresholdStage].output, params.morphKernelSize, stages[MorphologyStage].output);
+    }
+    if (isCancelled(cancel)) {
+        counted.cancelled = true;
+        return counted;
+    }
+
+    if (!isCurrent(ContourStage, 0, stages[MorphologyStage].version)) {
+        contours = externalContours(stages[MorphologyStage].output);
+        contourAreas.resize(contours.size());
+        for (size_t i = 0; i < contours.size(); i++) {
+            contourAreas[i] = cv::contourArea(contours[i]);
+        }
+    }
+
+    std::vector<std::vector<cv::Point>> filteredContours;
+    for (size_t i = 0; i < contours.size(); i++) {
+        if (contourAreas[i] >= params.minContourArea) {
+            filteredContours.push_back(contours[i]);
+        }
+    }
+    if (isCancelled(cancel)) {
+        counted.cancelled = true;
+        return counted;
+    }
+
+    const cv::Mat labels = labelObjects(inputImage.size(), filteredContours);
+    counted.objects = measureObjects(inputImage, labels, filteredContours);
+    counted.labelIndex = paletteIndex(labels);
+    counted.count = int(filteredContours.size());
+    counted.cache = cacheCounters();
+    return counted;
+}
+
+std::vector<CacheCounters> ObjectCounter::cacheCounters() const
+{
+    return std::vector<CacheCounters>(counters, counters + StageCount);
+}
+
+void ObjectCounter::clearCache()
+{
+    cachedInput = cv::Mat();
+    for (CachedStage& stage : stages) {
+        stage = CachedStage();
+    }
+    contours.clear();
+    contourAreas.clear();
+}
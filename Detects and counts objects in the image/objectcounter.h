@@ -0,0 +1,106 @@
+#ifndef OBJECTCOUNTER_H
+#define OBJECTCOUNTER_H
+
+#include "adaptivethreshold.h"
+#include "measurements.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CounterParams {
+    int thresholdValue = 100;
+    int blurAmount = 5;
+    double minContourArea = 500.0;
+    int morphKernelSize = 3;
+    ThresholdMode thresholdMode = GlobalThreshold;
+    int windowSize = 51;        // Sauvola and Niblack only, 3-301
+};
+
+struct CacheCounters {
+    std::string stage;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+// Intermediates of preprocessImage(), kept between calls on frames of one size.
+struct PreprocessBuffers {
+    cv::Mat gray;
+    cv::Mat blurred;
+    cv::Mat thresholded;
+    cv::Mat closed;
+    cv::Mat sums;               // integral images for the local thresholds
+    cv::Mat squares;
+};
+
+struct StageTiming {
+    std::string stage;
+    double milliseconds = 0;
+};
+
+struct CountResult {
+    cv::Mat labelIndex;         // CV_8U palette indices, see ObjectCounter::paletteColor()
+    int count = 0;
+    bool cancelled = false;
+    ObjectTable objects;
+    std::vector<CacheCounters> cache;
+};
+
+// The counting pipeline behind the GUI: grey, blur, inverted threshold (global or local),
+// closing, external contours filtered by area, then a label image of the kept objects and
+// their measurement table. The result is drawn as palette indices; the GUI adds the numbers
+// itself.
+//
+// process() keeps every stage's output keyed by its own parameter and the version of the
+// stage feeding it, so only the changed stage and those after it run again; a new
+// minimum area only re-filters the cached contours. preprocessImage() and findObjects()
+// are the same stages without the cache.
+class ObjectCounter
+{
+public:
+    static cv::Mat preprocessImage(const cv::Mat& inputImage, const CounterParams& params);
+    static const cv::Mat& preprocessImage(const cv::Mat& inputImage, const CounterParams& params,
+                                          PreprocessBuffers& buffers);
+    static std::vector<std::vector<cv::Point>> findObjects(const cv::Mat& preprocessed, const CounterParams& params);
+
+    // Runs each stage of process() once, without the cache, and times it.
+    static std::vector<StageTiming> profileStages(const cv::Mat& inputImage, const CounterParams& params);
+
+    // Object l is drawn with palette entry (l - 1) % 255 + 1, so colours stay the same from
+    // run to run; entry 0 is the black background.
+    static cv::Vec3b paletteColor(int index);
+    static cv::Mat paletteIndex(const cv::Mat& labels);
+
+    // cancel is checked between stages; a cancelled result carries no image.
+    CountResult process(const cv::Mat& inputImage, const CounterParams& params,
+                        const std::atomic<bool>* cancel = nullptr);
+
+    std::vector<CacheCounters> cacheCounters() const;
+    void clearCache();
+
+private:
+    enum Stage { GrayStage, BlurStage, ThresholdStage, MorphologyStage, ContourStage, StageCount };
+
+    struct CachedStage {
+        cv::Mat output;
+        int parameter = 0;
+        std::uint64_t upstream = 0;
+        std::uint64_t version = 0;
+    };
+
+    bool isCurrent(Stage stage, int parameter, std::uint64_t upstream);
+
+    cv::Mat cachedInput;
+    std::uint64_t inputVersion = 0;
+    std::uint64_t nextVersion = 0;
+    CachedStage stages[StageCount];
+    cv::Mat integralSums;
+    cv::Mat integralSquares;
+    CacheCounters counters[StageCount] = { { "gray" }, { "blur" }, { "threshold" }, { "morphology" }, { "contours" } };
+
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<double> contourAreas;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "stripreader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+static std::string lowerExtension(const std::string& path)
+{
+    std::string::size_type dot = path.find_last_of('.');
+    if (dot == std::string::npos) return std::string();
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+class PnmStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        in.open(path, std::ios::binary);
+        if (!in) {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        char magic[2] = {0, 0};
+        in.read(magic, 2);
+        if (magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+            error = "Only binary PPM/PGM (P5/P6) is supported";
+            return false;
+        }
+        channels = magic[1] == '6' ? 3 : 1;
+
+        int maxValue = 0;
+        if (!readHeaderNumber(imageWidth) || !readHeaderNumber(imageHeight) || !readHeaderNumber(maxValue)
+            || imageWidth <= 0 || imageHeight <= 0) {
+            error = "Invalid PNM header";
+            return false;
+        }
+        if (maxValue != 255) {
+            error = "Only 8-bit PNM is supported";
+            return false;
+        }
+        in.get();
+        dataStart = in.tellg();
+        return true;
+    }
+
+    bool readRegion(const cv::Rect& region, cv::Mat& window) override
+    {
+        raw.create(region.height, region.width, channels == 3 ? CV_8UC3 : CV_8UC1);
+        const std::streamsize rowBytes = static_cast<std::streamsize>(region.width) * channels;
+        for (int y = 0; y < region.height; ++y) {
+            const std::streamoff pixel = static_cast<std::streamoff>(region.y + y) * imageWidth + region.x;
+            in.seekg(dataStart + pixel * channels);
+            in.read(reinterpret_cast<char*>(raw.ptr(y)), rowBytes);
+            if (!in) return false;
+        }
+
+        cv::cvtColor(raw, window, channels == 3 ? cv::COLOR_RGB2BGR : cv::COLOR_GRAY2BGR);
+        return true;
+    }
+
+private:
+    bool readHeaderNumber(int& value)
+    {
+        int c = in.get();
+        while (in && (std::isspace(c) || c == '#')) {
+            if (c == '#') {
+                while (in && c != '\n') c = in.get();
+            }
+            c = in.get();
+        }
+        if (!in || !std::isdigit(c)) return false;
+
+        value = 0;
+        while (in && std::isdigit(c)) {
+            value = value * 10 + (c - '0');
+            c = in.get();
+        }
+        in.unget();
+        return true;
+    }
+
+    std::ifstream in;
+    std::streampos dataStart;
+    int channels = 3;
+    cv::Mat raw;
+};
+
+class TiffStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        in.open(path, std::ios::binary);
+        if (!in) {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        unsigned char header[8];
+        if (!in.read(reinterpret_cast<char*>(header), 8)) {
+            error = "Invalid TIFF header";
+            return false;
+        }
+        if (header[0] == 'I' && header[1] == 'I') {
+            bigEndian = false;
+        } else if (header[0] == 'M' && header[1] == 'M') {
+            bigEndian = true;
+        } else {
+            error = "Invalid TIFF header";
+            return false;
+        }
+        if (get16(header + 2) != 42) {
+            error = "BigTIFF is not supported";
+            return false;
+        }
+
+        in.seekg(get32(header + 4));
+        unsigned char countBytes[2];
+        if (!in.read(reinterpret_cast<char*>(countBytes), 2)) {
+            error = "Invalid TIFF directory";
+            return false;
+        }
+        std::vector<unsigned char> entries(get16(countBytes) * 12);
+        in.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+
+        uint32_t compression = 1, planar = 1, photometric = 2, bitsPerSample = 8;
+        std::vector<uint32_t> values;
+        for (size_t i = 0; in && i < entries.size(); i += 12) {
+            const unsigned char* entry = entries.data() + i;
+            uint16_t tag = get16(entry);
+            if (!readValues(entry, values) || values.empty()) continue;
+
+            switch (tag) {
+            case 256: imageWidth = static_cast<int>(values[0]); break;
+            case 257: imageHeight = static_cast<int>(values[0]); break;
+            case 258: bitsPerSample = values[0]; break;
+            case 259: compression = values[0]; break;
+            case 262: photometric = values[0]; break;
+            case 273: stripOffsets = values; break;
+            case 277: samples = static_cast<int>(values[0]); break;
+            case 278: rowsPerStrip = values[0]; break;
+            case 284: planar = values[0]; break;
+            case 322: error = "Tiled TIFF is not supported"; return false;
+            }
+        }
+
+        if (!in || imageWidth <= 0 || imageHeight <= 0 || stripOffsets.empty()) {
+            error = "Invalid TIFF directory";
+            return false;
+        }
+        if (compression != 1 || planar != 1 || bitsPerSample != 8 || (samples != 1 && samples != 3 && samples != 4)) {
+            error = "Only uncompressed 8-bit grey/RGB/RGBA TIFF can be streamed";
+            return false;
+        }
+        minIsWhite = photometric == 0;
+        // 0 is invalid; like the TIFF default it is read as one strip for the whole image.
+        if (rowsPerStrip == 0) rowsPerStrip = static_cast<uint32_t>(imageHeight);
+        rowsPerStrip = std::min<uint32_t>(rowsPerStrip, static_cast<uint32_t>(imageHeight));
+        return true;
+    }
+
+    bool readRegion(const cv::Rect& region, cv::Mat& window) override
+    {
+        const std::streamoff rowBytes = static_cast<std::streamoff>(imageWidth) * samples;
+        raw.create(region.height, region.width, CV_8UC(samples));
+
+        for (int y = 0; y < region.height; ++y) {
+            const uint32_t row = static_cast<uint32_t>(region.y + y);
+            const size_t stripIndex = row / rowsPerStrip;
+            if (stripIndex >= stripOffsets.size()) return false;
+
+            in.seekg(static_cast<std::streamoff>(stripOffsets[stripIndex]) + (row % rowsPerStrip) * rowBytes
+                     + static_cast<std::streamoff>(region.x) * samples);
+            in.read(reinterpret_cast<char*>(raw.ptr(y)), static_cast<std::streamsize>(region.width) * samples);
+            if (!in) return false;
+        }
+
+        if (samples == 3) {
+            cv::cvtColor(raw, window, cv::COLOR_RGB2BGR);
+        } else if (samples == 4) {
+            cv::cvtColor(raw, window, cv::COLOR_RGBA2BGR);
+        } else {
+            if (minIsWhite) cv::bitwise_not(raw, raw);
+            cv::cvtColor(raw, window, cv::COLOR_GRAY2BGR);
+        }
+        return true;
+    }
+
+private:
+    uint16_t get16(const unsigned char* p) const
+    {
+        return bigEndian ? static_cast<uint16_t>((p[0] << 8) | p[1])
+                         : static_cast<uint16_t>((p[1] << 8) | p[0]);
+    }
+
+    uint32_t get32(const unsigned char* p) const
+    {
+        return bigEndian ? (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]
+                         : (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | p[0];
+    }
+
+    bool readValues(const unsigned char* entry, std::vector<uint32_t>& values)
+    {
+        uint16_t type = get16(entry + 2);
+        uint32_t count = get32(entry + 4);
+        size_t size = type == 3 ? 2 : type == 4 ? 4 : 0;
+        values.clear();
+        if (size == 0 || count == 0) return false;
+
+        std::vector<unsigned char> data(count * size);
+        if (data.size() <= 4) {
+            std::copy(entry + 8, entry + 8 + data.size(), data.begin());
+        } else {
+            std::streampos position = in.tellg();
+            in.seekg(get32(entry + 8));
+            in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            in.seekg(position);
+            if (!in) return false;
+        }
+
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(size == 2 ? get16(data.data() + i * 2) : get32(data.data() + i * 4));
+        }
+        return true;
+    }
+
+    std::ifstream in;
+    bool bigEndian = false;
+    bool minIsWhite = false;
+    int samples = 1;
+    uint32_t rowsPerStrip = 0xFFFFFFFF;
+    std::vector<uint32_t> stripOffsets;
+    cv::Mat raw;
+};
+
+class FullImageStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        image = cv::imread(path);
+        if (image.empty()) {
+            error = "Could not load " + path;
+            return false;
+        }
+        imageWidth = image.cols;
+        imageHeight = image.rows;
+        return true;
+    }
+
+    bool isStreaming() const override { return false; }
+
+    bool readRegion(const cv::Rect& region, cv::Mat& window) override
+    {
+        image(region).copyTo(window);
+        return true;
+    }
+
+private:
+    cv::Mat image;
+};
+
+std::unique_ptr<StripReader> StripReader::open(const std::string& path, std::string& error)
+{
+    std::string ext = lowerExtension(path);
+
+    if (ext == "ppm" || ext == "pgm" || ext == "pnm") {
+        std::unique_ptr<PnmStripReader> reader(new PnmStripReader);
+        if (reader->openFile(path, error)) return reader;
+        return nullptr;
+    }
+
+    if (ext == "tif" || ext == "tiff") {
+        std::unique_ptr<TiffStripReader> reader(new TiffStripReader);
+        if (reader->openFile(path, error)) return reader;
+        // Compressed TIFF: decoded whole, like in the window
+    }
+
+    std::unique_ptr<FullImageStripReader> reader(new FullImageStripReader);
+    if (reader->openFile(path, error)) return reader;
+    return nullptr;
+}
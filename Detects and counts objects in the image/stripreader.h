@@ -0,0 +1,34 @@
+#ifndef STRIPREADER_H
+#define STRIPREADER_H
+
+#include <opencv2/opencv.hpp>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Reads rectangular windows of an image without loading it whole. Binary PPM/PGM and
+// uncompressed strip TIFF are read straight from disk, row segment by row segment; other
+// formats go through cv::imread and are not memory-bounded.
+//
+// The PNM/TIFF parsing is adapted from the strip reader in "Remove background and add any
+// background behind" (stripio.cpp). The apps build separately, so a fix to one belongs in both.
+class StripReader {
+public:
+    virtual ~StripReader() = default;
+
+    static std::unique_ptr<StripReader> open(const std::string& path, std::string& error);
+
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    virtual bool isStreaming() const { return true; }
+
+    // Fills window (CV_8UC3, BGR) with region, which must lie inside the image.
+    virtual bool readRegion(const cv::Rect& region, cv::Mat& window) = 0;
+
+protected:
+    int imageWidth = 0;
+    int imageHeight = 0;
+};
+
+#endif
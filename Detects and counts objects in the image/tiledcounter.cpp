@@ -0,0 +1,197 @@
+#include "tiledcounter.h"
+#include "stripreader.h"
+
+TiledCounter::TiledCounter(const TiledCountSettings& settings)
+    : settings(settings)
+    , haloSize(0)
+    , imageWidth(0)
+    , tiles(0)
+    , streaming(false)
+    , estimatedPeakBytes(0)
+{
+}
+
+// The core plus its halo, clipped to the image, so the filters see the same borders there.
+cv::Rect TiledCounter::windowFor(const cv::Rect& core, int imageHeight) const
+{
+    const int x0 = std::max(0, core.x - haloSize);
+    const int x1 = std::min(imageWidth, core.x + core.width + haloSize);
+    const int y0 = std::max(0, core.y - haloSize);
+    const int y1 = std::min(imageHeight, core.y + core.height + haloSize);
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+void TiledCounter::labelTile(const cv::Mat& window, const cv::Point& origin, TileLabels& tile) const
+{
+    const cv::Rect& core = tile.core;
+    cv::Mat mask = ObjectCounter::preprocessImage(window, settings.params);
+    cv::Mat coreMask = mask(cv::Rect(core.x - origin.x, core.y - origin.y, core.width, core.height));
+
+    cv::Mat labels;
+    tile.labelCount = cv::connectedComponentsWithStats(coreMask, labels, tile.stats, tile.centroids, 8, CV_32S);
+
+    tile.top.assign(labels.ptr<int>(0), labels.ptr<int>(0) + core.width);
+    tile.bottom.assign(labels.ptr<int>(core.height - 1), labels.ptr<int>(core.height - 1) + core.width);
+    tile.left.resize(core.height);
+    tile.right.resize(core.height);
+    for (int y = 0; y < core.height; y++) {
+        tile.left[y] = labels.at<int>(y, 0);
+        tile.right[y] = labels.at<int>(y, core.width - 1);
+    }
+}
+
+int TiledCounter::globalId(const TileLabels& tile, int label) const
+{
+    return label == 0 ? -1 : tile.firstId + label - 1;
+}
+
+int TiledCounter::find(int id)
+{
+    while (components[id].parent != id) {
+        components[id].parent = components[components[id].parent].parent;
+        id = components[id].parent;
+    }
+    return id;
+}
+
+void TiledCounter::unite(int a, int b)
+{
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (b < a) std::swap(a, b);
+
+    Component& root = components[a];
+    const Component& merged = components[b];
+    root.area += merged.area;
+    root.sumX += merged.sumX;
+    root.sumY += merged.sumY;
+    root.minX = std::min(root.minX, merged.minX);
+    root.minY = std::min(root.minY, merged.minY);
+    root.maxX = std::max(root.maxX, merged.maxX);
+    root.maxY = std::max(root.maxY, merged.maxY);
+    components[b].parent = a;
+}
+
+bool TiledCounter::run(const std::string& path)
+{
+    std::unique_ptr<StripReader> reader = StripReader::open(path, error);
+    if (!reader) return false;
+
+    streaming = reader->isStreaming();
+    imageWidth = reader->width();
+    const int imageHeight = reader->height();
+    const int tileSize = std::max(64, settings.tileSize);
+    const int tilesX = (imageWidth + tileSize - 1) / tileSize;
+
+    // Gaussian radius, the local threshold window's radius, then dilate and erode radii of
+    // the closing, with a pixel to spare.
+    haloSize = settings.params.blurAmount + 2 * (settings.params.morphKernelSize / 2) + 1;
+    if (settings.params.thresholdMode != GlobalThreshold) {
+        haloSize += settings.params.windowSize / 2;
+    }
+
+    // Windows are read one group at a time (the reader is a single file stream) and the
+    // group is labelled in parallel. The seam rows and tile edges are ints across the width.
+    const int threads = std::max(1, cv::getNumThreads());
+    const size_t windowPixels = size_t(tileSize + 2 * haloSize) * size_t(tileSize + 2 * haloSize);
+    estimatedPeakBytes = size_t(threads) * windowPixels * (3 + 3 + 4 + 4 + 4 + 4)
+                       + size_t(imageWidth) * 5 * sizeof(int);
+
+    components.clear();
+    objects.clear();
+    tiles = 0;
+
+    std::vector<int> previousBottom;
+
+    for (int coreTop = 0; coreTop < imageHeight; coreTop += tileSize) {
+        const int coreBottom = std::min(coreTop + tileSize, imageHeight);
+
+        std::vector<TileLabels> row(tilesX);
+        for (int t = 0; t < tilesX; t++) {
+            row[t].core = cv::Rect(t * tileSize, coreTop, std::min(tileSize, imageWidth - t * tileSize),
+                                   coreBottom - coreTop);
+        }
+
+        std::vector<cv::Mat> windows(std::min(threads, tilesX));
+        for (int first = 0; first < tilesX; first += int(windows.size())) {
+            const int group = std::min(int(windows.size()), tilesX - first);
+            for (int i = 0; i < group; i++) {
+                if (!reader->readRegion(windowFor(row[first + i].core, imageHeight), windows[i])) {
+                    error = "Could not read the tile at row " + std::to_string(coreTop) + ", column "
+                          + std::to_string(row[first + i].core.x) + " of " + path;
+                    return false;
+                }
+            }
+            cv::parallel_for_(cv::Range(0, group), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; i++) {
+                    TileLabels& tile = row[first + i];
+                    labelTile(windows[i], windowFor(tile.core, imageHeight).tl(), tile);
+                }
+            });
+        }
+        tiles += tilesX;
+
+        for (TileLabels& tile : row) {
+            tile.firstId = int(components.size());
+            for (int label = 1; label < tile.labelCount; label++) {
+                const int* s = tile.stats.ptr<int>(label);
+                const double area = s[cv::CC_STAT_AREA];
+                const double* c = tile.centroids.ptr<double>(label);
+                const int left = tile.core.x + s[cv::CC_STAT_LEFT];
+                const int top = tile.core.y + s[cv::CC_STAT_TOP];
+                components.push_back({int(components.size()), area,
+                                      (tile.core.x + c[0]) * area, (tile.core.y + c[1]) * area,
+                                      left, top, left + s[cv::CC_STAT_WIDTH] - 1, top + s[cv::CC_STAT_HEIGHT] - 1});
+            }
+        }
+
+        // Vertical seams inside the tile row, including the diagonal neighbours.
+        for (int t = 1; t < tilesX; t++) {
+            const TileLabels& a = row[t - 1];
+            const TileLabels& b = row[t];
+            for (int y = 0; y < a.core.height; y++) {
+                if (a.right[y] == 0) continue;
+                for (int dy = -1; dy <= 1; dy++) {
+                    const int ny = y + dy;
+                    if (ny >= 0 && ny < b.core.height && b.left[ny] != 0) {
+                        unite(globalId(a, a.right[y]), globalId(b, b.left[ny]));
+                    }
+                }
+            }
+        }
+
+        // Horizontal seam with the tile row above, over the full width so corners are covered.
+        std::vector<int> currentTop(imageWidth), currentBottom(imageWidth);
+        for (const TileLabels& tile : row) {
+            for (int x = 0; x < tile.core.width; x++) {
+                currentTop[tile.core.x + x] = globalId(tile, tile.top[x]);
+                currentBottom[tile.core.x + x] = globalId(tile, tile.bottom[x]);
+            }
+        }
+        if (!previousBottom.empty()) {
+            for (int x = 0; x < imageWidth; x++) {
+                if (previousBottom[x] < 0) continue;
+                for (int dx = -1; dx <= 1; dx++) {
+                    const int nx = x + dx;
+                    if (nx >= 0 && nx < imageWidth && currentTop[nx] >= 0) {
+                        unite(previousBottom[x], currentTop[nx]);
+                    }
+                }
+            }
+        }
+        previousBottom.swap(currentBottom);
+    }
+
+    for (int id = 0; id < int(components.size()); id++) {
+        const Component& c = components[id];
+        if (c.parent != id || c.area < settings.params.minContourArea) continue;
+
+        TiledObject object;
+        object.area = c.area;
+        object.centroid = cv::Point2d(c.sumX / c.area, c.sumY / c.area);
+        object.boundingBox = cv::Rect(cv::Point(c.minX, c.minY), cv::Point(c.maxX + 1, c.maxY + 1));
+        objects.push_back(object);
+    }
+    return true;
+}
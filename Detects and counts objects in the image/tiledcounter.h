@@ -0,0 +1,81 @@
+#ifndef TILEDCOUNTER_H
+#define TILEDCOUNTER_H
+
+#include "objectcounter.h"
+#include <string>
+#include <vector>
+
+struct TiledCountSettings {
+    CounterParams params;
+    int tileSize = 1024;
+};
+
+struct TiledObject {
+    double area = 0;            // in pixels
+    cv::Point2d centroid;
+    cv::Rect boundingBox;
+};
+
+// Counts objects in images too large for processAndCountObjects. Each tile is read from
+// disk as its own window with a halo (blur, local threshold and closing radii) around it and
+// preprocessed with it, so its mask is identical to the whole-image mask; then it is labelled
+// on its own. One tile per thread is in flight at a time. Labels touching across tile seams
+// (8-connected, like findContours) are merged with union-find, so an object spanning tiles
+// is counted once. Peak memory is one tile window and its intermediates per thread, plus
+// the seam labels: a few int rows across the image width.
+//
+// Objects are kept by pixel area >= minContourArea; contourArea() in the window measures
+// the outline polygon instead, so counts near the limit can differ slightly. Unlike
+// RETR_EXTERNAL, an object lying inside another one's hole is counted on its own.
+class TiledCounter
+{
+public:
+    explicit TiledCounter(const TiledCountSettings& settings);
+
+    bool run(const std::string& path);
+
+    std::string errorString() const { return error; }
+    int count() const { return int(objects.size()); }
+    const std::vector<TiledObject>& objectList() const { return objects; }
+    int tileCount() const { return tiles; }
+    int halo() const { return haloSize; }
+    bool isStreaming() const { return streaming; }
+    size_t peakBytes() const { return estimatedPeakBytes; }
+
+private:
+    struct Component {
+        int parent;
+        double area;
+        double sumX;
+        double sumY;
+        int minX, minY, maxX, maxY;
+    };
+
+    struct TileLabels {
+        cv::Rect core;
+        int firstId = 0;
+        cv::Mat stats;
+        cv::Mat centroids;
+        int labelCount = 0;
+        std::vector<int> top, bottom, left, right;
+    };
+
+    cv::Rect windowFor(const cv::Rect& core, int imageHeight) const;
+    void labelTile(const cv::Mat& window, const cv::Point& origin, TileLabels& tile) const;
+    int globalId(const TileLabels& tile, int label) const;
+    int find(int id);
+    void unite(int a, int b);
+
+    TiledCountSettings settings;
+    std::string error;
+    int haloSize;
+    int imageWidth;
+    int tiles;
+    bool streaming;
+    size_t estimatedPeakBytes;
+
+    std::vector<Component> components;
+    std::vector<TiledObject> objects;
+};
+
+#endif
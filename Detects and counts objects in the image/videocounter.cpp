@@ -0,0 +1,127 @@
+#include "videocounter.h"
+#include <algorithm>
+
+VideoCounter::VideoCounter(const VideoCountSettings& settings)
+    : settings(settings)
+    , frameIndex(0)
+    , nextTrackId(1)
+{
+}
+
+static double intersectionOverUnion(const cv::Rect& a, const cv::Rect& b)
+{
+    const double overlap = (a & b).area();
+    return overlap > 0 ? overlap / (a.area() + b.area() - overlap) : 0;
+}
+
+double VideoCounter::side(const cv::Point2d& point) const
+{
+    if (settings.line.horizontal) {
+        return point.y - settings.line.position * frameSize.height;
+    }
+    return point.x - settings.line.position * frameSize.width;
+}
+
+void VideoCounter::processFrame(const cv::Mat& frame)
+{
+    frameSize = frame.size();
+    findBlobs(ObjectCounter::preprocessImage(frame, settings.params, buffers));
+    associate();
+    frameIndex++;
+}
+
+void VideoCounter::findBlobs(const cv::Mat& mask)
+{
+    const int labelCount = cv::connectedComponentsWithStats(mask, labels, stats, centroids, 8, CV_32S);
+
+    blobs.clear();
+    for (int label = 1; label < labelCount; label++) {
+        const int* s = stats.ptr<int>(label);
+        if (s[cv::CC_STAT_AREA] < settings.params.minContourArea) continue;
+
+        const double* c = centroids.ptr<double>(label);
+        blobs.push_back({ cv::Rect(s[cv::CC_STAT_LEFT], s[cv::CC_STAT_TOP], s[cv::CC_STAT_WIDTH], s[cv::CC_STAT_HEIGHT]),
+                          cv::Point2d(c[0], c[1]) });
+    }
+}
+
+// Candidate pairs are ranked by IoU, then by distance for pairs that do not overlap, and
+// taken greedily; with at most a few hundred objects per frame this is cheap and, for
+// objects that move less than their own size between frames, gives the same pairs as an
+// optimal assignment.
+void VideoCounter::associate()
+{
+    struct Candidate {
+        double iou;
+        double distance;
+        int track;
+        int blob;
+    };
+    std::vector<Candidate> candidates;
+    for (int t = 0; t < int(tracks.size()); t++) {
+        for (int b = 0; b < int(blobs.size()); b++) {
+            const double iou = intersectionOverUnion(tracks[t].box, blobs[b].box);
+            const double distance = cv::norm(tracks[t].centroid - blobs[b].centroid);
+            if (iou >= settings.minIoU || distance <= settings.maxDistance) {
+                candidates.push_back({ iou, distance, t, b });
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.iou != b.iou) return a.iou > b.iou;
+        return a.distance < b.distance;
+    });
+
+    std::vector<char> trackMatched(tracks.size(), 0), blobMatched(blobs.size(), 0);
+    for (const Candidate& candidate : candidates) {
+        if (trackMatched[candidate.track] || blobMatched[candidate.blob]) continue;
+        trackMatched[candidate.track] = 1;
+        blobMatched[candidate.blob] = 1;
+
+        Track& track = tracks[candidate.track];
+        const Blob& blob = blobs[candidate.blob];
+        const double before = side(track.centroid);
+        const double after = side(blob.centroid);
+        if (!track.counted && before != 0 && (before < 0) != (after < 0)) {
+            track.counted = true;
+            events.push_back({ frameIndex, track.id, after > before ? 1 : -1, blob.centroid });
+        }
+        track.box = blob.box;
+        track.centroid = blob.centroid;
+        track.missed = 0;
+    }
+
+    for (int t = 0; t < int(tracks.size()); t++) {
+        if (!trackMatched[t]) tracks[t].missed++;
+    }
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [this](const Track& track) {
+        return track.missed > settings.maxMissedFrames;
+    }), tracks.end());
+
+    for (int b = 0; b < int(blobs.size()); b++) {
+        if (!blobMatched[b]) {
+            tracks.push_back({ nextTrackId++, blobs[b].box, blobs[b].centroid, 0, false });
+        }
+    }
+}
+
+void VideoCounter::annotate(cv::Mat& frame) const
+{
+    if (settings.line.horizontal) {
+        const int y = int(settings.line.position * frame.rows);
+        cv::line(frame, cv::Point(0, y), cv::Point(frame.cols - 1, y), cv::Scalar(0, 0, 255), 2);
+    } else {
+        const int x = int(settings.line.position * frame.cols);
+        cv::line(frame, cv::Point(x, 0), cv::Point(x, frame.rows - 1), cv::Scalar(0, 0, 255), 2);
+    }
+
+    for (const Track& track : tracks) {
+        if (track.missed > 0) continue;
+        const cv::Vec3b color = ObjectCounter::paletteColor((track.id - 1) % 255 + 1);
+        cv::rectangle(frame, track.box, cv::Scalar(color[0], color[1], color[2]), 2);
+        cv::putText(frame, std::to_string(track.id), track.box.tl() + cv::Point(2, 14),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+    }
+    cv::putText(frame, "Count: " + std::to_string(count()), cv::Point(10, 30),
+                cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 2);
+}
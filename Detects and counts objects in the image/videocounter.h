@@ -0,0 +1,80 @@
+#ifndef VIDEOCOUNTER_H
+#define VIDEOCOUNTER_H
+
+#include "objectcounter.h"
+#include <string>
+#include <vector>
+
+// Where objects are counted: a horizontal line at position * height, or a vertical one at
+// position * width.
+struct CountingLine {
+    bool horizontal = true;
+    double position = 0.5;
+};
+
+struct VideoCountSettings {
+    CounterParams params;
+    CountingLine line;
+    double minIoU = 0.1;            // bounding-box overlap that links a blob to a track
+    double maxDistance = 60;        // or centroid distance in pixels, when they do not overlap
+    int maxMissedFrames = 5;
+};
+
+struct CrossingEvent {
+    int frame = 0;
+    int trackId = 0;
+    int direction = 0;              // +1 down or right, -1 up or left
+    cv::Point2d centroid;
+};
+
+// Counts objects moving through a video (file or camera). Every frame goes through
+// preprocessImage() with buffers kept between frames, blobs come from
+// connectedComponentsWithStats (pixel area >= minContourArea), and are linked to the tracks
+// of the previous frames greedily by bounding-box IoU, then centroid distance. A track is
+// counted once, the first time its centroid changes side of the counting line.
+class VideoCounter
+{
+public:
+    explicit VideoCounter(const VideoCountSettings& settings);
+
+    // One frame of the stream; frames must all be the same size.
+    void processFrame(const cv::Mat& frame);
+
+    int count() const { return int(events.size()); }
+    int framesProcessed() const { return frameIndex; }
+    int activeTracks() const { return int(tracks.size()); }
+    const std::vector<CrossingEvent>& crossings() const { return events; }
+
+    // Draws the line, the current tracks with their ids and the count onto frame.
+    void annotate(cv::Mat& frame) const;
+
+private:
+    struct Blob {
+        cv::Rect box;
+        cv::Point2d centroid;
+    };
+
+    struct Track {
+        int id;
+        cv::Rect box;
+        cv::Point2d centroid;
+        int missed;
+        bool counted;
+    };
+
+    double side(const cv::Point2d& point) const;
+    void findBlobs(const cv::Mat& mask);
+    void associate();
+
+    VideoCountSettings settings;
+    PreprocessBuffers buffers;
+    cv::Mat labels, stats, centroids;
+    std::vector<Blob> blobs;
+    std::vector<Track> tracks;
+    std::vector<CrossingEvent> events;
+    cv::Size frameSize;
+    int frameIndex;
+    int nextTrackId;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "autocutout.h"
+#include <QElapsedTimer>
+#include <opencv2/opencv.hpp>
+#include <cmath>
+#include <vector>
+
+static const double kProxyPixels = 512.0 * 512.0;
+static const int kMaxIterations = 8;
+static const int kGuideRadius = 4;              // in proxy pixels
+static const double kGuideEpsilon = 1e-4;       // guide intensities are 0-1
+
+static cv::Mat boxMean(const cv::Mat& input)
+{
+    cv::Mat mean;
+    cv::boxFilter(input, mean, CV_32F, cv::Size(2 * kGuideRadius + 1, 2 * kGuideRadius + 1));
+    return mean;
+}
+
+// Bilinear sample positions (pixel centres aligned, as INTER_LINEAR) of a proxy axis of
+// length proxy for each of full output positions.
+struct LinearTaps {
+    std::vector<int> first;
+    std::vector<float> weight;   // of first + 1
+};
+
+static LinearTaps linearTaps(int full, int proxy)
+{
+    LinearTaps taps;
+    taps.first.resize(full);
+    taps.weight.resize(full);
+    const double ratio = double(proxy) / full;
+    for (int i = 0; i < full; ++i) {
+        const double position = qBound(0.0, (i + 0.5) * ratio - 0.5, double(proxy - 1));
+        taps.first[i] = qMin(int(position), qMax(0, proxy - 2));
+        taps.weight[i] = proxy > 1 ? float(position - taps.first[i]) : 0.f;
+    }
+    return taps;
+}
+
+static void interpolateRow(const cv::Mat& proxy, const LinearTaps& columns, int row, float rowWeight, float* out)
+{
+    const float* top = proxy.ptr<float>(row);
+    const float* bottom = proxy.ptr<float>(qMin(row + 1, proxy.rows - 1));
+    for (size_t x = 0; x < columns.first.size(); ++x) {
+        const int c = columns.first[x];
+        const int c1 = qMin(c + 1, proxy.cols - 1);
+        const float w = columns.weight[x];
+        const float upper = top[c] + w * (top[c1] - top[c]);
+        const float lower = bottom[c] + w * (bottom[c1] - bottom[c]);
+        out[x] = upper + rowWeight * (lower - upper);
+    }
+}
+
+QImage autoCutout(const QImage& image, const QRect& rect, int timeBudgetMs, CutoutStats* stats)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QImage input = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const cv::Mat full(input.height(), input.width(), CV_8UC4,
+                       const_cast<uchar*>(input.constBits()), input.bytesPerLine());
+
+    const double scale = qMin(1.0, std::sqrt(kProxyPixels / (double(input.width()) * input.height())));
+    const cv::Size proxySize(qMax(1, qRound(input.width() * scale)), qMax(1, qRound(input.height() * scale)));
+    cv::Mat proxyBgra, proxy;
+    cv::resize(full, proxyBgra, proxySize, 0, 0, cv::INTER_AREA);
+    cv::cvtColor(proxyBgra, proxy, cv::COLOR_BGRA2BGR);
+
+    // GrabCut needs some background outside the rectangle, so keep a one-pixel border.
+    const double sx = double(proxySize.width) / input.width();
+    const double sy = double(proxySize.height) / input.height();
+    cv::Rect proxyRect(int(std::floor(rect.x() * sx)), int(std::floor(rect.y() * sy)),
+                       int(std::ceil(rect.width() * sx)), int(std::ceil(rect.height() * sy)));
+    proxyRect &= cv::Rect(1, 1, proxySize.width - 2, proxySize.height - 2);
+    if (proxyRect.width < 2 || proxyRect.height < 2) return QImage();
+
+    cv::Mat mask, backgroundModel, foregroundModel;
+    QElapsedTimer iterationTimer;
+    iterationTimer.start();
+    cv::grabCut(proxy, mask, proxyRect, backgroundModel, foregroundModel, 1, cv::GC_INIT_WITH_RECT);
+    qint64 lastIteration = iterationTimer.elapsed();
+    int iterations = 1;
+
+    while (iterations < kMaxIterations && timer.elapsed() + lastIteration <= timeBudgetMs) {
+        iterationTimer.restart();
+        cv::grabCut(proxy, mask, proxyRect, backgroundModel, foregroundModel, 1, cv::GC_EVAL);
+        lastIteration = iterationTimer.elapsed();
+        ++iterations;
+    }
+
+    // Fast guided filter: the linear coefficients a, b are solved on the proxy with its
+    // grey image as guide, then upsampled and applied to the full-resolution grey values.
+    cv::Mat guide, foreground;
+    cv::cvtColor(proxyBgra, guide, cv::COLOR_BGRA2GRAY);
+    guide.convertTo(guide, CV_32F, 1.0 / 255);
+    cv::Mat(mask & 1).convertTo(foreground, CV_32F);
+
+    const cv::Mat meanGuide = boxMean(guide);
+    const cv::Mat meanForeground = boxMean(foreground);
+    const cv::Mat varianceGuide = boxMean(guide.mul(guide)) - meanGuide.mul(meanGuide);
+    const cv::Mat covariance = boxMean(guide.mul(foreground)) - meanGuide.mul(meanForeground);
+    const cv::Mat a = covariance / (varianceGuide + kGuideEpsilon);
+    const cv::Mat b = meanForeground - a.mul(meanGuide);
+
+    // a and b are upsampled one output row at a time inside each strip, so no full-size
+    // float planes are ever allocated (they would be 8 bytes per pixel).
+    const cv::Mat meanA = boxMean(a);
+    const cv::Mat meanB = boxMean(b);
+    const LinearTaps columns = linearTaps(input.width(), proxySize.width);
+    const LinearTaps rows = linearTaps(input.height(), proxySize.height);
+
+    QImage output(input.size(), QImage::Format_ARGB32_Premultiplied);
+    const uchar* inputBits = input.constBits();
+    const qsizetype inputStride = input.bytesPerLine();
+    uchar* outputBits = output.bits();
+    const qsizetype outputStride = output.bytesPerLine();
+
+    cv::parallel_for_(cv::Range(0, input.height()), [&](const cv::Range& range) {
+        std::vector<float> rowA(input.width()), rowB(input.width());
+        for (int y = range.start; y < range.end; ++y) {
+            const QRgb* src = reinterpret_cast<const QRgb*>(inputBits + y * inputStride);
+            QRgb* dst = reinterpret_cast<QRgb*>(outputBits + y * outputStride);
+            interpolateRow(meanA, columns, rows.first[y], rows.weight[y], rowA.data());
+            interpolateRow(meanB, columns, rows.first[y], rows.weight[y], rowB.data());
+
+            for (int x = 0; x < input.width(); ++x) {
+                const QRgb p = src[x];
+                const float grey = (0.299f * qRed(p) + 0.587f * qGreen(p) + 0.114f * qBlue(p)) / 255.f;
+                const int alpha = qBound(0, int((rowA[x] * grey + rowB[x]) * 255.f + 0.5f), 255);
+
+                if (alpha == 255) {
+                    dst[x] = p;
+                } else if (alpha == 0) {
+                    dst[x] = 0;
+                } else {
+                    dst[x] = qRgba((qRed(p) * alpha + 127) / 255, (qGreen(p) * alpha + 127) / 255,
+                                   (qBlue(p) * alpha + 127) / 255, (qAlpha(p) * alpha + 127) / 255);
+                }
+            }
+        }
+    });
+
+    if (stats) {
+        stats->iterations = iterations;
+        stats->proxySize = QSize(proxySize.width, proxySize.height);
+        stats->milliseconds = timer.elapsed();
+    }
+    return output;
+}
@@ -0,0 +1,22 @@
+#ifndef AUTOCUTOUT_H
+#define AUTOCUTOUT_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+struct CutoutStats {
+    int iterations = 0;
+    QSize proxySize;
+    qint64 milliseconds = 0;
+};
+
+// Automatic foreground extraction seeded from rect (image pixels). GrabCut runs on a proxy
+// of about a quarter megapixel, taking more iterations only while the next one still fits
+// in timeBudgetMs; the proxy mask is then brought to full resolution with a fast guided
+// filter, so the alpha follows edges of the full-size image rather than proxy pixels.
+// Returns image with the background made transparent, or a null image if rect is too small.
+// Touches no GUI state, so it can run on a worker thread.
+QImage autoCutout(const QImage& image, const QRect& rect, int timeBudgetMs, CutoutStats* stats = nullptr);
+
+#endif
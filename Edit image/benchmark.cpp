@@ -0,0 +1,111 @@
+#include "benchmark.h"
+#include "chromakey.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+bool isBenchmarkInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark") == 0) return true;
+    }
+    return false;
+}
+
+// The removeBackground loop as it was before chromaKey(), kept as the reference.
+static QImage chromaKeyPixelColor(const QImage& image, const QColor& selectedColor)
+{
+    QImage newImage(image.size(), QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            QColor pixelColor = image.pixelColor(x, y);
+            if (qAbs(pixelColor.red() - selectedColor.red()) < 30 &&
+                qAbs(pixelColor.green() - selectedColor.green()) < 30 &&
+                qAbs(pixelColor.blue() - selectedColor.blue()) < 30) {
+                newImage.setPixelColor(x, y, QColor(0, 0, 0, 0));
+            } else {
+                newImage.setPixelColor(x, y, pixelColor);
+            }
+        }
+    }
+    return newImage;
+}
+
+// Green screen with a grid of coloured discs whose edges are semi-transparent, so both
+// branches and the unpremultiply path are exercised.
+static QImage syntheticOverlay(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    const int cell = 200;
+
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const int dx = x % cell - cell / 2;
+            const int dy = y % cell - cell / 2;
+            const int distance = int(std::sqrt(double(dx * dx + dy * dy)));
+            const int index = (x / cell) * 7 + (y / cell) * 13;
+
+            if (distance < 60) {
+                line[x] = qRgb((index * 53) % 256, (index * 97) % 256, (x ^ y) & 0xFF);
+            } else if (distance < 68) {
+                const int alpha = 255 - (distance - 60) * 30;
+                line[x] = qPremultiply(qRgba(200, (index * 31) % 256, 60, alpha));
+            } else {
+                line[x] = qRgb(40 + (x + y) % 24, 200, 60);
+            }
+        }
+    }
+    return image;
+}
+
+template <typename Function>
+static qint64 bestOf(int runs, Function function)
+{
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < runs; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        function();
+        best = std::min(best, timer.elapsed());
+    }
+    return best;
+}
+
+int runBenchmark(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+    const bool skipReference = arguments.contains("--no-reference");
+    const QColor key(40, 200, 60);
+
+    struct Size { int megapixels; int width; int height; };
+    const Size sizes[] = { {12, 4000, 3000}, {24, 6000, 4000}, {48, 8000, 6000} };
+
+    out << "chroma key, tolerance 30\n";
+    out << "MP\tpixelColor ms\tchromaKey ms\tspeedup\tidentical\n";
+    int mismatches = 0;
+    for (const Size& size : sizes) {
+        const QImage overlay = syntheticOverlay(size.width, size.height);
+
+        QImage fast;
+        const qint64 fastMs = bestOf(5, [&] { fast = chromaKey(overlay, key, 30); });
+
+        if (skipReference) {
+            out << size.megapixels << "\t-\t" << fastMs << "\t-\t-\n";
+        } else {
+            QImage reference;
+            const qint64 referenceMs = bestOf(1, [&] { reference = chromaKeyPixelColor(overlay, key); });
+            out << size.megapixels << "\t" << referenceMs << "\t" << fastMs << "\t"
+                << QString::number(double(referenceMs) / qMax<qint64>(1, fastMs), 'f', 1) << "x\t"
+                << (reference == fast ? "yes" : "NO") << "\n";
+            if (reference != fast) ++mismatches;
+        }
+        out.flush();
+    }
+    return mismatches == 0 ? 0 : 1;
+}
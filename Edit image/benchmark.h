@@ -0,0 +1,11 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QStringList>
+
+// Started with --benchmark; prints timings to stdout instead of opening the window. Returns 1
+// if the fast key differs from the pixelColor reference at any size.
+bool isBenchmarkInvocation(int argc, char *argv[]);
+int runBenchmark(const QStringList& arguments);
+
+#endif
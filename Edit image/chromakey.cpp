@@ -0,0 +1,216 @@
+#include "chromakey.h"
+#include <QRgba64>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHROMAKEY_SSE2
+#endif
+
+template <typename Function>
+static void forEachRowBand(int height, Function function)
+{
+    const int bandHeight = qMax(16, height / qMax(1, QThreadPool::globalInstance()->maxThreadCount() * 4));
+    std::vector<int> bands;
+    for (int y = 0; y < height; y += bandHeight) {
+        bands.push_back(y);
+    }
+
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        function(firstRow, qMin(firstRow + bandHeight, height));
+    });
+}
+
+// pixelColor() unpremultiplies through QRgba64; doing the same here keeps semi-transparent
+// pixels identical to the old per-pixel loop.
+static void unpremultiplyRow(const QRgb* src, QRgb* dst, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const QRgb p = src[x];
+        dst[x] = qAlpha(p) == 255 ? p : QRgba64::fromArgb32(p).unpremultiplied().toArgb32();
+    }
+}
+
+static void keyRow(const QRgb* src, QRgb* dst, int width, QRgb key, int tolerance)
+{
+    int x = 0;
+
+#ifdef CHROMAKEY_SSE2
+    // |p - key| per byte via two saturating subtractions; a channel matches when the
+    // difference minus (tolerance - 1) saturates to zero.
+    const __m128i keyVector = _mm_set1_epi32(static_cast<int>(key));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(tolerance - 1));
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(pixels, keyVector), _mm_subs_epu8(keyVector, pixels));
+        const __m128i outside = _mm_and_si128(_mm_subs_epu8(diff, limit), rgbMask);
+        const __m128i match = _mm_cmpeq_epi32(outside, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_andnot_si128(match, pixels));
+    }
+#endif
+
+    const int keyRed = qRed(key);
+    const int keyGreen = qGreen(key);
+    const int keyBlue = qBlue(key);
+    for (; x < width; ++x) {
+        const QRgb p = src[x];
+        if (qAbs(qRed(p) - keyRed) < tolerance &&
+            qAbs(qGreen(p) - keyGreen) < tolerance &&
+            qAbs(qBlue(p) - keyBlue) < tolerance) {
+            dst[x] = 0;
+        } else {
+            dst[x] = p;
+        }
+    }
+}
+
+QImage chromaKey(const QImage& source, const QColor& key, int tolerance)
+{
+    QImage input = source;
+    const bool premultiplied = input.format() == QImage::Format_ARGB32_Premultiplied;
+    if (!premultiplied && input.format() != QImage::Format_ARGB32 && input.format() != QImage::Format_RGB32) {
+        input = input.convertToFormat(QImage::Format_ARGB32);
+    }
+
+    QImage result(input.size(), QImage::Format_ARGB32);
+    if (input.isNull() || result.isNull()) return result;
+
+    const QRgb keyRgb = key.rgb() & 0x00FFFFFF;
+    tolerance = qBound(0, tolerance, 256);
+
+    const int width = input.width();
+    const int height = input.height();
+    const uchar* inputBits = input.constBits();
+    const qsizetype inputStride = input.bytesPerLine();
+    uchar* resultBits = result.bits();
+    const qsizetype resultStride = result.bytesPerLine();
+
+    forEachRowBand(height, [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; ++y) {
+            const QRgb* src = reinterpret_cast<const QRgb*>(inputBits + y * inputStride);
+            QRgb* dst = reinterpret_cast<QRgb*>(resultBits + y * resultStride);
+
+            if (premultiplied) {
+                unpremultiplyRow(src, dst, width);
+                src = dst;
+            }
+            if (tolerance > 0) {
+                keyRow(src, dst, width, keyRgb, tolerance);
+            } else if (src != dst) {
+                std::copy(src, src + width, dst);
+            }
+        }
+    });
+
+    return result;
+}
+
+SoftChromaKey::SoftChromaKey(const SoftKeySettings& settings)
+    : settings(settings)
+{
+    static const double cbCoefficients[3] = { -0.168736, -0.331264, 0.5 };
+    static const double crCoefficients[3] = { 0.5, -0.418688, -0.081312 };
+
+    for (int channel = 0; channel < 3; ++channel) {
+        for (int v = 0; v < 256; ++v) {
+            cbTable[channel][v] = int(std::lround(cbCoefficients[channel] * v * 16));
+            crTable[channel][v] = int(std::lround(crCoefficients[channel] * v * 16));
+        }
+    }
+
+    const QRgb key = settings.key.rgb();
+    keyCb = cbTable[0][qRed(key)] + cbTable[1][qGreen(key)] + cbTable[2][qBlue(key)];
+    keyCr = crTable[0][qRed(key)] + crTable[1][qGreen(key)] + crTable[2][qBlue(key)];
+
+    // Indexed by squared CbCr distance in whole units; 2 * 255^2 covers every pair of colours.
+    const double tolerance = qMax(0, settings.tolerance);
+    const double softness = qMax(0, settings.softness);
+    alphaTable.resize(2 * 255 * 255 + 1);
+    for (size_t i = 0; i < alphaTable.size(); ++i) {
+        const double distance = std::sqrt(double(i));
+        if (distance <= tolerance) {
+            alphaTable[i] = 0;
+        } else if (softness <= 0 || distance >= tolerance + softness) {
+            alphaTable[i] = 255;
+        } else {
+            const double t = (distance - tolerance) / softness;
+            alphaTable[i] = uchar(std::lround(255 * t * t * (3 - 2 * t)));
+        }
+    }
+
+    const double keyLength = std::hypot(keyCb / 16.0, keyCr / 16.0);
+    const double strength = qBound(0, settings.spill, 100) / 100.0;
+    spillCb = keyLength > 1 ? float(keyCb / 16.0 / keyLength) : 0.f;
+    spillCr = keyLength > 1 ? float(keyCr / 16.0 / keyLength) : 0.f;
+    spillStrength = keyLength > 1 ? float(strength) : 0.f;
+}
+
+void SoftChromaKey::applyRow(const QRgb* src, QRgb* dst, int width) const
+{
+    const int lastIndex = int(alphaTable.size()) - 1;
+
+    for (int x = 0; x < width; ++x) {
+        const QRgb p = src[x];
+        int red = qRed(p);
+        int green = qGreen(p);
+        int blue = qBlue(p);
+
+        const int cb = cbTable[0][red] + cbTable[1][green] + cbTable[2][blue];
+        const int cr = crTable[0][red] + crTable[1][green] + crTable[2][blue];
+        const int dCb = cb - keyCb;
+        const int dCr = cr - keyCr;
+        const int index = qMin((dCb * dCb + dCr * dCr) >> 8, lastIndex);
+        const int alpha = (alphaTable[index] * qAlpha(p) + 127) / 255;
+
+        if (alpha == 0) {
+            dst[x] = 0;
+            continue;
+        }
+
+        // Remove the part of the pixel's chroma that points towards the key colour.
+        if (spillStrength > 0) {
+            const float projection = (cb * spillCb + cr * spillCr) / 16.f;
+            if (projection > 0) {
+                const float removeCb = -projection * spillStrength * spillCb;
+                const float removeCr = -projection * spillStrength * spillCr;
+                red = qBound(0, int(std::lround(red + 1.402f * removeCr)), 255);
+                green = qBound(0, int(std::lround(green - 0.344136f * removeCb - 0.714136f * removeCr)), 255);
+                blue = qBound(0, int(std::lround(blue + 1.772f * removeCb)), 255);
+            }
+        }
+
+        dst[x] = qPremultiply(qRgba(red, green, blue, alpha));
+    }
+}
+
+QImage SoftChromaKey::apply(const QImage& source) const
+{
+    QImage input = source;
+    if (input.format() != QImage::Format_ARGB32 && input.format() != QImage::Format_RGB32) {
+        input = input.convertToFormat(QImage::Format_ARGB32);
+    }
+
+    QImage result(input.size(), QImage::Format_ARGB32_Premultiplied);
+    if (input.isNull() || result.isNull()) return result;
+
+    const int width = input.width();
+    const uchar* inputBits = input.constBits();
+    const qsizetype inputStride = input.bytesPerLine();
+    uchar* resultBits = result.bits();
+    const qsizetype resultStride = result.bytesPerLine();
+
+    forEachRowBand(input.height(), [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; ++y) {
+            applyRow(reinterpret_cast<const QRgb*>(inputBits + y * inputStride),
+                     reinterpret_cast<QRgb*>(resultBits + y * resultStride), width);
+        }
+    });
+
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef CHROMAKEY_H
+#define CHROMAKEY_H
+
+#include <QColor>
+#include <QImage>
+#include <vector>
+
+// Makes every pixel whose red, green and blue are all within tolerance of key fully
+// transparent. Works on ARGB32 scanlines, four pixels per SSE2 compare, with row bands
+// spread over the global thread pool. Same output as the old pixelColor/setPixelColor loop.
+QImage chromaKey(const QImage& source, const QColor& key, int tolerance);
+
+struct SoftKeySettings {
+    QColor key;
+    int tolerance = 30;
+    int softness = 10;
+    int spill = 0;
+};
+
+// Keys on the distance between CbCr (BT.601) chroma and the key's chroma, so shading of the
+// backdrop matters less than with per-channel RGB limits. Alpha ramps smoothly from 0 at
+// tolerance to 255 at tolerance + softness, and spill (0-100) strips the key's chroma from
+// the pixels that remain. Colour conversion and the alpha ramp are lookup tables built once.
+class SoftChromaKey {
+public:
+    explicit SoftChromaKey(const SoftKeySettings& settings);
+
+    // Returns ARGB32_Premultiplied.
+    QImage apply(const QImage& source) const;
+
+private:
+    void applyRow(const QRgb* src, QRgb* dst, int width) const;
+
+    SoftKeySettings settings;
+    int cbTable[3][256];
+    int crTable[3][256];
+    int keyCb;
+    int keyCr;
+    std::vector<uchar> alphaTable;
+    float spillCb;
+    float spillCr;
+    float spillStrength;
+};
+
+#endif
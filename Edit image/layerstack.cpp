@@ -0,0 +1,183 @@
+#include "layerstack.h"
+#include <utility>
+
+static QImage premultiplied(const QImage& image) {
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+void LayerStack::setBackground(const QImage& image, qreal scale) {
+    background = premultiplied(image);
+    viewScale = scale;
+    invalidate();
+}
+
+void LayerStack::clear() {
+    layers.clear();
+    invalidate();
+}
+
+QRectF LayerStack::bounds(int index) const {
+    const Layer& layer = layers[index];
+    return QRectF(layer.position, QSizeF(layer.image.size()) * layer.scale);
+}
+
+int LayerStack::layerAt(const QPointF& point) const {
+    for (int i = layers.size() - 1; i >= 0; --i) {
+        if (bounds(i).contains(point)) return i;
+    }
+    return -1;
+}
+
+int LayerStack::addLayer(const QString& name, const QImage& image, const QPointF& position, qreal scale) {
+    Layer layer;
+    layer.name = name;
+    layer.image = premultiplied(image);
+    layer.position = position;
+    layer.scale = scale;
+    layers.append(layer);
+    invalidate();
+    return layers.size() - 1;
+}
+
+void LayerStack::removeLayer(int index) {
+    layers.remove(index);
+    invalidate();
+}
+
+void LayerStack::moveLayer(int from, int to) {
+    layers.move(from, to);
+    invalidate();
+}
+
+void LayerStack::setImage(int index, const QImage& image) {
+    layers[index].image = premultiplied(image);
+    layers[index].preview = QImage();
+    layerChanged(index);
+}
+
+QImage LayerStack::takeImage(int index) {
+    return std::move(layers[index].image);
+}
+
+void LayerStack::setPreview(int index, const QImage& preview) {
+    layers[index].preview = preview.isNull() ? QImage() : premultiplied(preview);
+    layerChanged(index);
+}
+
+void LayerStack::clearPreviews() {
+    for (Layer& layer : layers) {
+        layer.preview = QImage();
+    }
+    invalidate();
+}
+
+void LayerStack::setGeometry(int index, const QPointF& position, qreal scale) {
+    layers[index].position = position;
+    layers[index].scale = scale;
+    layerChanged(index);
+}
+
+void LayerStack::setOpacity(int index, qreal opacity) {
+    layers[index].opacity = opacity;
+    layerChanged(index);
+}
+
+// Changing a mode can split or join Normal runs, so every cache is rebuilt.
+void LayerStack::setMode(int index, QPainter::CompositionMode mode) {
+    layers[index].mode = mode;
+    invalidate();
+}
+
+void LayerStack::layerChanged(int index) {
+    if (index != hotIndex) {
+        hotIndex = index;
+        cachesValid = false;
+    }
+}
+
+void LayerStack::invalidate() {
+    hotIndex = -1;
+    cachesValid = false;
+    below = QImage();
+    above.clear();
+}
+
+void LayerStack::drawLayer(QPainter& painter, const Layer& layer) const {
+    const QRectF target(layer.position * viewScale, QSizeF(layer.image.size()) * layer.scale * viewScale);
+    painter.setOpacity(layer.opacity);
+    painter.setCompositionMode(layer.mode);
+    painter.drawImage(target, layer.preview.isNull() ? layer.image : layer.preview);
+}
+
+void LayerStack::rebuildCaches() {
+    const int split = hotIndex < 0 ? layers.size() : hotIndex;
+
+    below = background.copy();
+    {
+        QPainter painter(&below);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        for (int i = 0; i < split; ++i) {
+            drawLayer(painter, layers[i]);
+        }
+    }
+
+    above.clear();
+    for (int i = split + 1; i < layers.size(); ) {
+        int last = i;
+        if (layers[i].mode == QPainter::CompositionMode_SourceOver) {
+            while (last + 1 < layers.size() && layers[last + 1].mode == QPainter::CompositionMode_SourceOver) {
+                ++last;
+            }
+        }
+
+        Run run { i, last, QImage() };
+        if (last > i) {
+            run.flattened = QImage(background.size(), QImage::Format_ARGB32_Premultiplied);
+            run.flattened.fill(Qt::transparent);
+            QPainter painter(&run.flattened);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform);
+            for (int j = i; j <= last; ++j) {
+                drawLayer(painter, layers[j]);
+            }
+        }
+        above.append(run);
+        i = last + 1;
+    }
+
+    cachesValid = true;
+}
+
+QImage LayerStack::composite() {
+    if (background.isNull()) return QImage();
+    if (!cachesValid) rebuildCaches();
+    if (hotIndex < 0) return below;
+
+    QImage result = below.copy();
+    QPainter painter(&result);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    drawLayer(painter, layers[hotIndex]);
+
+    for (const Run& run : above) {
+        if (run.flattened.isNull()) {
+            drawLayer(painter, layers[run.first]);
+        } else {
+            painter.setOpacity(1.0);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            painter.drawImage(0, 0, run.flattened);
+        }
+    }
+    return result;
+}
+
+QList<ExportLayer> LayerStack::exportLayers() const {
+    QList<ExportLayer> result;
+    for (int i = 0; i < layers.size(); ++i) {
+        ExportLayer layer;
+        layer.image = layers[i].image;
+        layer.target = bounds(i);
+        layer.opacity = layers[i].opacity;
+        layer.mode = layers[i].mode;
+        result.append(layer);
+    }
+    return result;
+}
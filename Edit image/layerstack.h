@@ -0,0 +1,81 @@
+#ifndef LAYERSTACK_H
+#define LAYERSTACK_H
+
+#include "tiledexport.h"
+#include <QImage>
+#include <QList>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// Overlays above one background, bottom to top. Layer images are kept as
+// ARGB32_Premultiplied and placed in background pixel coordinates; composite() renders at
+// the view scale of the background it was given.
+//
+// Compositing is cached around the last edited ("hot") layer: everything below it is one
+// flattened image, and every run of Normal layers above it is flattened on its own, which
+// is exact because source-over on premultiplied colour is associative. Dragging or
+// re-keying one layer therefore blends that layer and a handful of cached runs, however
+// many layers there are. Other blend modes above the hot layer are blended one by one.
+class LayerStack {
+public:
+    struct Layer {
+        QString name;
+        QImage image;
+        QImage preview;     // drawn instead of image when set, into the same rectangle
+        QPointF position;
+        qreal scale = 1.0;
+        qreal opacity = 1.0;
+        QPainter::CompositionMode mode = QPainter::CompositionMode_SourceOver;
+    };
+
+    void setBackground(const QImage& image, qreal viewScale);
+    void clear();
+
+    int count() const { return layers.size(); }
+    const Layer& layer(int index) const { return layers[index]; }
+    QRectF bounds(int index) const;
+    int layerAt(const QPointF& point) const;
+
+    int addLayer(const QString& name, const QImage& image, const QPointF& position, qreal scale);
+    void removeLayer(int index);
+    void moveLayer(int from, int to);
+
+    void setImage(int index, const QImage& image);
+    // Moves the image out, leaving the layer empty, so it can be edited in place without a
+    // copy; hand it back with setImage().
+    QImage takeImage(int index);
+    void setPreview(int index, const QImage& preview);
+    void clearPreviews();
+    void setGeometry(int index, const QPointF& position, qreal scale);
+    void setOpacity(int index, qreal opacity);
+    void setMode(int index, QPainter::CompositionMode mode);
+
+    QImage composite();
+    QList<ExportLayer> exportLayers() const;
+
+private:
+    struct Run {
+        int first;
+        int last;
+        QImage flattened;   // null for a single layer, which is blended directly
+    };
+
+    void layerChanged(int index);
+    void invalidate();
+    void rebuildCaches();
+    void drawLayer(QPainter& painter, const Layer& layer) const;
+
+    QImage background;
+    qreal viewScale = 1.0;
+    QVector<Layer> layers;
+
+    int hotIndex = -1;
+    bool cachesValid = false;
+    QImage below;
+    QVector<Run> above;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "magicwand.h"
+#include <cstring>
+#include <vector>
+
+static const uchar kSelected = 255;
+static const uchar kVisited = 1;    // reached by the fill in progress
+
+// convertToFormat() shares the data when the format already matches; a private copy leaves
+// the caller's image the only owner of its pixels, so addSeed() can clear them in place.
+static QImage ownedCopy(const QImage& image) {
+    const QImage converted = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    return converted.isDetached() ? converted : converted.copy();
+}
+
+MagicWand::MagicWand(const QImage& image)
+    : source(ownedCopy(image))
+    , mask(source.size(), QImage::Format_Grayscale8)
+{
+    mask.fill(0);
+}
+
+QRect MagicWand::addSeed(const QPoint& seed, int tolerance, QImage& target) {
+    const int width = source.width();
+    const int height = source.height();
+    if (!source.rect().contains(seed) || target.size() != source.size() ||
+        target.format() != QImage::Format_ARGB32_Premultiplied) {
+        return QRect();
+    }
+
+    tolerance = qBound(1, tolerance, 256);
+    const uchar* bits = source.constBits();
+    const qsizetype stride = source.bytesPerLine();
+    uchar* maskBits = mask.bits();
+    const qsizetype maskStride = mask.bytesPerLine();
+
+    // Per-channel byte ranges around the seed; previously selected pixels that match are
+    // walked through again, so a new region can connect across an old one.
+    const uchar* key = bits + seed.y() * stride + seed.x() * 4;
+    int low[4], high[4];
+    for (int c = 0; c < 4; ++c) {
+        low[c] = key[c] - tolerance + 1;
+        high[c] = key[c] + tolerance - 1;
+    }
+
+    auto fillable = [&](int x, int y) {
+        if (maskBits[y * maskStride + x] == kVisited) return false;
+        const uchar* p = bits + y * stride + x * 4;
+        return p[0] >= low[0] && p[0] <= high[0] && p[1] >= low[1] && p[1] <= high[1] &&
+               p[2] >= low[2] && p[2] <= high[2] && p[3] >= low[3] && p[3] <= high[3];
+    };
+
+    int left = seed.x(), right = seed.x(), top = seed.y(), bottom = seed.y();
+    std::vector<QPoint> stack;
+    stack.push_back(seed);
+
+    while (!stack.empty()) {
+        const QPoint point = stack.back();
+        stack.pop_back();
+
+        const int y = point.y();
+        if (!fillable(point.x(), y)) continue;
+
+        int x1 = point.x();
+        int x2 = point.x();
+        while (x1 > 0 && fillable(x1 - 1, y)) --x1;
+        while (x2 < width - 1 && fillable(x2 + 1, y)) ++x2;
+        std::memset(maskBits + y * maskStride + x1, kVisited, x2 - x1 + 1);
+
+        left = qMin(left, x1);
+        right = qMax(right, x2);
+        top = qMin(top, y);
+        bottom = qMax(bottom, y);
+
+        // One seed per run of fillable pixels in the rows above and below the span.
+        for (int ny = y - 1; ny <= y + 1; ny += 2) {
+            if (ny < 0 || ny >= height) continue;
+            bool inRun = false;
+            for (int x = x1; x <= x2; ++x) {
+                if (fillable(x, ny)) {
+                    if (!inRun) stack.push_back(QPoint(x, ny));
+                    inRun = true;
+                } else {
+                    inRun = false;
+                }
+            }
+        }
+    }
+
+    for (int y = top; y <= bottom; ++y) {
+        uchar* maskRow = maskBits + y * maskStride;
+        QRgb* outputRow = reinterpret_cast<QRgb*>(target.scanLine(y));
+        for (int x = left; x <= right; ++x) {
+            if (maskRow[x] == kVisited) {
+                maskRow[x] = kSelected;
+                outputRow[x] = 0;
+            }
+        }
+    }
+
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
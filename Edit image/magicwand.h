@@ -0,0 +1,29 @@
+#ifndef MAGICWAND_H
+#define MAGICWAND_H
+
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+
+// Connected-region selection on one image. Each seed selects the pixels reachable from
+// it whose four channels are all within tolerance of the seed pixel, using a scanline
+// span fill over an explicit stack. Seeds accumulate in one 8-bit mask; the wand keeps its
+// own copy of the image to match against, and clears each new region in the caller's image.
+class MagicWand {
+public:
+    explicit MagicWand(const QImage& image);
+
+    // Makes the region filled from seed transparent in target, which must be the image the
+    // wand was made from (or that image after earlier seeds), as ARGB32_Premultiplied. Pass
+    // an image nothing else shares, or the write detaches a full-size copy. Returns the
+    // bounding box of the region (empty if seed is outside).
+    QRect addSeed(const QPoint& seed, int tolerance, QImage& target);
+
+    const QImage& selection() const { return mask; }
+
+private:
+    QImage source;
+    QImage mask;
+};
+
+#endif
@@ -1,7 +1,13 @@
 #include "mainwindow.h"
+#include "benchmark.h"
 #include <QApplication>
 
 int main(int argc, char *argv[]) {
+    if (isBenchmarkInvocation(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return runBenchmark(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -1,17 +1,57 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "chromakey.h"
+#include "renditioncache.h"
+#include "tiledexport.h"
+#include "magicwand.h"
+#include "autocutout.h"
 #include <QFileDialog>
 #include <QPainter>
 #include <QColorDialog>
 #include <QMouseEvent>
 #include <QImageReader>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QStyle>
+#include <QtConcurrent>
 #include <QIcon>
 #include <QDebug>
+#include <QFileInfo>
+#include <QSignalBlocker>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <QRubberBand>
+#include <QApplication>
+#include <algorithm>
+#include <iterator>
+
+static const qreal kMaxZoom = 8.0;
+static const qreal kMaxViewportZoom = 2.0;
+static const qreal kMinDisplaySide = 32.0;
+
+static const QPainter::CompositionMode kBlendModes[] = {
+    QPainter::CompositionMode_SourceOver,
+    QPainter::CompositionMode_Multiply,
+    QPainter::CompositionMode_Screen,
+    QPainter::CompositionMode_Overlay,
+    QPainter::CompositionMode_Darken,
+    QPainter::CompositionMode_Lighten,
+    QPainter::CompositionMode_Plus,
+};
+
+// Auto cutout runs on a worker and hands back the cut-out layer with its timings.
+static const int kCutoutBudgetMs = 300;
+
+struct CutoutResult {
+    QImage image;
+    CutoutStats stats;
+};
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , activeLayer(-1)
 {
     ui->setupUi(this);
     initializeUI();
@@ -28,6 +68,27 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btnRemoveBackground, &QPushButton::clicked, this, &MainWindow::removeBackground);
     connect(ui->btnDelete, &QPushButton::clicked, this, &MainWindow::deleteSelected);
     connect(ui->btnSave, &QPushButton::clicked, this, &MainWindow::saveResult);
+    connect(ui->btnExport, &QPushButton::clicked, this, &MainWindow::exportFullResolution);
+
+    connect(ui->comboKeyMode, &QComboBox::currentIndexChanged, this, &MainWindow::updateKeyPreview);
+    connect(ui->sliderTolerance, &QSlider::valueChanged, this, &MainWindow::updateKeyPreview);
+    connect(ui->sliderSoftness, &QSlider::valueChanged, this, &MainWindow::updateKeyPreview);
+    connect(ui->sliderSpill, &QSlider::valueChanged, this, &MainWindow::updateKeyPreview);
+    connect(ui->checkMagicWand, &QCheckBox::toggled, this, &MainWindow::magicWandToggled);
+    connect(ui->btnAutoCut, &QPushButton::toggled, this, &MainWindow::autoCutoutToggled);
+
+    connect(backgroundLabel, &CustomLabel::renditionShown, this, &MainWindow::backgroundShown);
+    connect(backgroundLabel, &CanvasLabel::pressed, this, &MainWindow::selectLayerAt);
+    connect(backgroundLabel, &CanvasLabel::dragged, this, &MainWindow::moveActiveLayer);
+    connect(backgroundLabel, &CanvasLabel::wheelScaled, this, &MainWindow::scaleActiveLayer);
+    connect(backgroundLabel, &CanvasLabel::rectangleSelected, this, &MainWindow::cutOutRectangle);
+
+    connect(ui->listLayers, &QListWidget::currentRowChanged, this, &MainWindow::layerSelectionChanged);
+    connect(ui->btnLayerUp, &QPushButton::clicked, this, &MainWindow::raiseLayer);
+    connect(ui->btnLayerDown, &QPushButton::clicked, this, &MainWindow::lowerLayer);
+    connect(ui->sliderOpacity, &QSlider::valueChanged, this, &MainWindow::updateLayerOpacity);
+    connect(ui->comboBlendMode, &QComboBox::currentIndexChanged, this, &MainWindow::updateLayerMode);
+    setActiveLayer(-1);
 }
 
 MainWindow::~MainWindow() {
@@ -35,59 +96,144 @@ MainWindow::~MainWindow() {
 }
 
 void MainWindow::initializeUI() {
-    backgroundLabel = new CustomLabel(this);
+    backgroundLabel = new CanvasLabel(this);
     backgroundLabel->setMinimumSize(600, 400);
     backgroundLabel->setAlignment(Qt::AlignCenter);
     backgroundLabel->setStyleSheet("QLabel { background-color: white; border: 1px solid gray; }");
 
-    overlayLabel = new CustomLabel(this);
-    overlayLabel->setMinimumSize(100, 100);
-    overlayLabel->setStyleSheet("QLabel { background: transparent; }");
-
     ui->imageContainer->addWidget(backgroundLabel);
-    ui->imageContainer->addWidget(overlayLabel);
-    overlayLabel->hide();
 }
 
 CustomLabel::CustomLabel(QWidget* parent)
     : QLabel(parent)
-    , isDragging(false)
+    , renditions(new RenditionCache(this))
+    , scale(1.0)
 {
     setMouseTracking(true);
+    connect(renditions, &RenditionCache::renditionReady, this, &CustomLabel::renditionReady);
 }
 
-void CustomLabel::mousePressEvent(QMouseEvent* event) {
-    if (event->button() == Qt::LeftButton) {
-        isDragging = true;
-        dragStartPosition = event->pos();
-        labelStartPosition = pos();
+void CustomLabel::setSourceImage(const QImage& image) {
+    renditions->setSource(image);
+    if (image.isNull()) {
+        clear();
+        return;
     }
+
+    scale = qMin(qreal(width()) / image.width(), qreal(height()) / image.height());
+    showRendition();
 }
 
-void CustomLabel::mouseMoveEvent(QMouseEvent* event) {
-    if (isDragging) {
-        move(labelStartPosition + (event->pos() - dragStartPosition));
-    }
+QImage CustomLabel::displayImage() {
+    return renditions->rendition(displaySize);
 }
 
-void CustomLabel::mouseReleaseEvent(QMouseEvent*) {
-    isDragging = false;
+QImage CustomLabel::sourceImage() const {
+    return renditions->source();
+}
+
+QRect CustomLabel::pixmapRect() const {
+    const QPixmap current = pixmap();
+    if (current.isNull()) return QRect();
+
+    const QRect contents = contentsRect().adjusted(margin(), margin(), -margin(), -margin());
+    return QStyle::alignedRect(layoutDirection(), QStyle::visualAlignment(layoutDirection(), alignment()),
+                               current.deviceIndependentSize().toSize(), contents);
+}
+
+void CustomLabel::showRendition() {
+    const QImage source = renditions->source();
+    if (source.isNull()) return;
+
+    displaySize = QSize(qMax(1, qRound(source.width() * scale)), qMax(1, qRound(source.height() * scale)));
+    setPixmap(QPixmap::fromImage(renditions->rendition(displaySize)));
+    emit renditionShown();
+}
+
+void CustomLabel::renditionReady(const QSize& size, const QImage& image) {
+    if (size == displaySize) {
+        setPixmap(QPixmap::fromImage(image));
+        emit renditionShown();
+    }
 }
 
+// The zoom is a factor against the source image, so repeated notches never rescale an
+// already rescaled pixmap; RenditionCache supplies the pixels. It stops at kMaxZoom times the
+// source and at kMinDisplaySide when zooming out. A rendition is built whole, not just the part
+// the label shows, so it is also kept within kMaxViewportZoom times the label.
 void CustomLabel::wheelEvent(QWheelEvent* event) {
-    QSize currentSize = pixmap().size();
+    const QImage source = renditions->source();
+    if (source.isNull()) return;
+
+    const qreal longSide = qMax(source.width(), source.height());
+    const qreal maxScale = qMin(kMaxZoom, kMaxViewportZoom * qMax(width(), height()) / longSide);
+    const qreal minScale = qMin(kMinDisplaySide / longSide, maxScale);
+    scale = qBound(minScale, scale * (event->angleDelta().y() > 0 ? 1.1 : 0.9), maxScale);
+    showRendition();
+}
+
+CanvasLabel::CanvasLabel(QWidget* parent)
+    : CustomLabel(parent)
+    , isDragging(false)
+    , rectangleMode(false)
+    , rubberBand(new QRubberBand(QRubberBand::Rectangle, this))
+{
+}
+
+void CanvasLabel::setRectangleMode(bool enabled) {
+    rectangleMode = enabled;
+    rubberBand->hide();
+    setCursor(enabled ? Qt::CrossCursor : Qt::ArrowCursor);
+}
+
+QPointF CanvasLabel::toImage(const QPoint& position) const {
+    return QPointF(position - pixmapRect().topLeft()) / zoom();
+}
+
+void CanvasLabel::mousePressEvent(QMouseEvent* event) {
+    if (rectangleMode && event->button() == Qt::LeftButton) {
+        rectangleOrigin = event->pos();
+        rubberBand->setGeometry(QRect(rectangleOrigin, QSize()));
+        rubberBand->show();
+        return;
+    }
 
-    if (event->angleDelta().y() > 0) {
-        QSize newSize = currentSize * 1.1;
-        setPixmap(pixmap().scaled(newSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-    } else {
-        QSize newSize = currentSize * 0.9;
-        setPixmap(pixmap().scaled(newSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    if (event->button() == Qt::LeftButton && !pixmap().isNull()) {
+        isDragging = true;
+        lastPosition = event->pos();
+        emit pressed(toImage(event->pos()));
     }
 }
 
+void CanvasLabel::mouseMoveEvent(QMouseEvent* event) {
+    if (rubberBand->isVisible()) {
+        rubberBand->setGeometry(QRect(rectangleOrigin, event->pos()).normalized());
+        return;
+    }
 
+    if (isDragging) {
+        emit dragged(QPointF(event->pos() - lastPosition) / zoom());
+        lastPosition = event->pos();
+    }
+}
+
+void CanvasLabel::mouseReleaseEvent(QMouseEvent*) {
+    isDragging = false;
 
+    if (rubberBand->isVisible()) {
+        const QRect band = rubberBand->geometry();
+        rubberBand->hide();
+        emit rectangleSelected(QRectF(toImage(band.topLeft()), toImage(band.bottomRight())).normalized());
+    }
+}
+
+void CanvasLabel::wheelEvent(QWheelEvent* event) {
+    if (event->modifiers() & Qt::ControlModifier) {
+        CustomLabel::wheelEvent(event);
+        return;
+    }
+    emit wheelScaled(event->angleDelta().y() > 0 ? 1.1 : 0.9);
+}
 
 void MainWindow::loadBackground() {
     QString filePath = QFileDialog::getOpenFileName(this,
@@ -103,13 +249,18 @@ void MainWindow::loadBackground() {
             return;
         }
 
-        backgroundPixmap = QPixmap::fromImage(image);
-        backgroundLabel->setPixmap(backgroundPixmap.scaled(backgroundLabel->size(),
-        Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        backgroundLabel->setSourceImage(image);
     }
 }
 
+// New layers go on top, centred and no larger than half the background.
 void MainWindow::loadOverlay() {
+    const QImage background = backgroundLabel->sourceImage();
+    if (background.isNull()) {
+        QMessageBox::warning(this, tr("Error"), tr("Please load a background image first."));
+        return;
+    }
+
     QString filePath = QFileDialog::getOpenFileName(this,
         tr("Open Overlay Image"), QString(), tr("Images (*.png *.jpg *.jpeg *.bmp *.gif)"));
 
@@ -123,52 +274,41 @@ void MainWindow::loadOverlay() {
             return;
         }
 
-        overlayPixmap = QPixmap::fromImage(image);
-        overlayLabel->setPixmap(overlayPixmap.scaled(overlayLabel->size(),
-        Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        overlayLabel->show();
-        overlayLabel->raise();
+        const qreal scale = qMin<qreal>(1.0, qMin(0.5 * background.width() / image.width(),
+                                                  0.5 * background.height() / image.height()));
+        const QPointF position((background.width() - image.width() * scale) / 2,
+                               (background.height() - image.height() * scale) / 2);
+        const int index = layers.addLayer(QFileInfo(filePath).fileName(), image, position, scale);
+        syncLayerList();
+        setActiveLayer(index);
     }
 }
 
 void MainWindow::removeBackground() {
-    if (overlayPixmap.isNull() || !selectedColor.isValid()) {
+    if (activeLayer < 0 || !selectedColor.isValid()) {
         QMessageBox::warning(this, tr("Error"),
         tr("Please load an overlay image and select a color first."));
         return;
     }
 
-    QImage image = overlayPixmap.toImage();
-    QImage newImage(image.size(), QImage::Format_ARGB32);
-
-    for (int y = 0; y < image.height(); ++y) {
-        for (int x = 0; x < image.width(); ++x) {
-            QColor pixelColor = image.pixelColor(x, y);
-            if (qAbs(pixelColor.red() - selectedColor.red()) < 30 &&
-                qAbs(pixelColor.green() - selectedColor.green()) < 30 &&
-                qAbs(pixelColor.blue() - selectedColor.blue()) < 30) {
-                newImage.setPixelColor(x, y, QColor(0, 0, 0, 0));  // Set transparent color
-            } else {
-                newImage.setPixelColor(x, y, pixelColor);
-            }
-        }
-    }
-
-    overlayPixmap = QPixmap::fromImage(newImage);
-    overlayLabel->setPixmap(overlayPixmap.scaled(overlayLabel->size(),
-        Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    // Once committed the key is part of the layer; forgetting the colour keeps the preview
+    // and the export from keying it a second time.
+    wand.reset();
+    layers.setImage(activeLayer, applyKey(layers.layer(activeLayer).image));
+    selectedColor = QColor();
+    updateKeyPreview();
 }
 
 void MainWindow::deleteSelected() {
-    if (overlayLabel->isVisible()) {
-        overlayLabel->clear();
-        overlayLabel->hide();
-        overlayPixmap = QPixmap();
+    if (activeLayer >= 0) {
+        layers.removeLayer(activeLayer);
+        syncLayerList();
+        setActiveLayer(qMin(activeLayer, layers.count() - 1));
     }
 }
 
 void MainWindow::saveResult() {
-    if (backgroundPixmap.isNull()) {
+    if (backgroundLabel->pixmap().isNull()) {
         QMessageBox::warning(this, tr("Error"), tr("No image to save."));
         return;
     }
@@ -177,23 +317,287 @@ void MainWindow::saveResult() {
         tr("Save Image"), QString(), tr("PNG (*.png);;JPEG (*.jpg *.jpeg);;BMP (*.bmp)"));
 
     if (!filePath.isEmpty()) {
-        QPixmap result(backgroundLabel->size());
-        result.fill(Qt::transparent);
+        if (!backgroundLabel->pixmap().save(filePath)) {
+            QMessageBox::warning(this, tr("Error"), tr("Could not save image."));
+        }
+    }
+}
 
-        QPainter painter(&result);
-        painter.drawPixmap(0, 0, backgroundLabel->pixmap());
+// Renders at the background's own resolution from the full-size layer images; layer
+// geometry is already kept in background pixels.
+void MainWindow::exportFullResolution() {
+    const QImage background = backgroundLabel->sourceImage();
+    if (background.isNull()) {
+        QMessageBox::warning(this, tr("Error"), tr("No image to save."));
+        return;
+    }
 
-        if (!overlayPixmap.isNull() && overlayLabel->isVisible()) {
-            QPoint overlayPos = overlayLabel->pos() - backgroundLabel->pos();
-            painter.drawPixmap(overlayPos, overlayLabel->pixmap());
-        }
+    QString filePath = QFileDialog::getSaveFileName(this,
+        tr("Export Full Resolution"), QString(), tr("PNG (*.png);;TIFF (*.tif *.tiff)"));
+    if (filePath.isEmpty()) return;
+
+    // Same condition as updateKeyPreview(), so the file matches what is on screen; a committed
+    // key has already cleared selectedColor.
+    QList<ExportLayer> exportLayers = layers.exportLayers();
+    if (activeLayer >= 0 && selectedColor.isValid() && !ui->checkMagicWand->isChecked()) {
+        exportLayers[activeLayer].image = applyKey(exportLayers[activeLayer].image);
+    }
 
-        if (!result.save(filePath)) {
-            QMessageBox::warning(this, tr("Error"), tr("Could not save image."));
+    auto* progress = new QProgressDialog(tr("Exporting..."), tr("Cancel"), 0, background.height(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+
+    auto* watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<QString>::cancel);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, progress]() {
+        watcher->deleteLater();
+        progress->close();
+        if (watcher->isCanceled() || watcher->future().resultCount() == 0) return;
+
+        const QString error = watcher->result();
+        if (!error.isEmpty()) {
+            QMessageBox::warning(this, tr("Error"), error);
         }
-    }
+    });
+    watcher->setFuture(QtConcurrent::run(exportTiled, filePath, background, exportLayers));
 }
 
 void MainWindow::pickColor() {
     selectedColor = QColorDialog::getColor(Qt::white, this, tr("Select Color to Remove"));
+    updateKeyPreview();
+}
+
+// Runs the key on a screen-sized copy of the active layer so the sliders respond
+// immediately; removeBackground() applies the same settings to the full-resolution image.
+void MainWindow::updateKeyPreview() {
+    const bool soft = ui->comboKeyMode->currentIndex() == 1;
+    ui->sliderSoftness->setEnabled(soft);
+    ui->sliderSpill->setEnabled(soft);
+
+    if (activeLayer >= 0 && selectedColor.isValid() && !ui->checkMagicWand->isChecked()) {
+        const QSize displaySize = (layers.bounds(activeLayer).size() * backgroundLabel->zoom()).toSize();
+        if (!displaySize.isEmpty()) {
+            const QImage proxy = layers.layer(activeLayer).image.scaled(displaySize, Qt::IgnoreAspectRatio,
+                                                                        Qt::FastTransformation);
+            layers.setPreview(activeLayer, applyKey(proxy));
+        }
+    }
+    refreshCanvas();
+}
+
+void MainWindow::refreshCanvas() {
+    const QImage composite = layers.composite();
+    if (!composite.isNull()) {
+        backgroundLabel->setPixmap(QPixmap::fromImage(composite));
+    }
+}
+
+// A new background rendition (load or view zoom) changes the scale of everything drawn.
+void MainWindow::backgroundShown() {
+    layers.setBackground(backgroundLabel->displayImage(), backgroundLabel->zoom());
+    updateKeyPreview();
+}
+
+void MainWindow::selectLayerAt(const QPointF& imagePosition) {
+    if (ui->checkMagicWand->isChecked()) {
+        selectRegionAt(imagePosition);
+        return;
+    }
+
+    const int index = layers.layerAt(imagePosition);
+    if (index >= 0 && index != activeLayer) {
+        setActiveLayer(index);
+    }
+}
+
+void MainWindow::moveActiveLayer(const QPointF& imageDelta) {
+    if (activeLayer < 0 || ui->checkMagicWand->isChecked()) return;
+
+    const LayerStack::Layer& layer = layers.layer(activeLayer);
+    layers.setGeometry(activeLayer, layer.position + imageDelta, layer.scale);
+    refreshCanvas();
+}
+
+// Scales about the layer's centre, like the old overlay zoom.
+void MainWindow::scaleActiveLayer(qreal factor) {
+    if (activeLayer < 0) return;
+
+    const QRectF bounds = layers.bounds(activeLayer);
+    const QPointF position = bounds.center() - (bounds.center() - bounds.topLeft()) * factor;
+    layers.setGeometry(activeLayer, position, layers.layer(activeLayer).scale * factor);
+    updateKeyPreview();
+}
+
+// The list shows the top layer first.
+void MainWindow::syncLayerList() {
+    QSignalBlocker blocker(ui->listLayers);
+    ui->listLayers->clear();
+    for (int i = layers.count() - 1; i >= 0; --i) {
+        ui->listLayers->addItem(layers.layer(i).name);
+    }
+}
+
+void MainWindow::setActiveLayer(int index) {
+    activeLayer = index;
+    wand.reset();
+    layers.clearPreviews();
+
+    {
+        QSignalBlocker listBlocker(ui->listLayers);
+        QSignalBlocker opacityBlocker(ui->sliderOpacity);
+        QSignalBlocker modeBlocker(ui->comboBlendMode);
+        ui->listLayers->setCurrentRow(index < 0 ? -1 : layers.count() - 1 - index);
+
+        if (index >= 0) {
+            const LayerStack::Layer& layer = layers.layer(index);
+            ui->sliderOpacity->setValue(qRound(layer.opacity * 100));
+            ui->comboBlendMode->setCurrentIndex(int(std::find(std::begin(kBlendModes), std::end(kBlendModes), layer.mode)
+                                                    - std::begin(kBlendModes)));
+        }
+    }
+
+    const bool enabled = index >= 0;
+    ui->btnLayerUp->setEnabled(enabled && index < layers.count() - 1);
+    ui->btnLayerDown->setEnabled(enabled && index > 0);
+    ui->sliderOpacity->setEnabled(enabled);
+    ui->comboBlendMode->setEnabled(enabled);
+    updateKeyPreview();
+}
+
+void MainWindow::layerSelectionChanged() {
+    const int row = ui->listLayers->currentRow();
+    setActiveLayer(row < 0 ? -1 : layers.count() - 1 - row);
+}
+
+void MainWindow::raiseLayer() {
+    if (activeLayer < 0 || activeLayer >= layers.count() - 1) return;
+
+    layers.moveLayer(activeLayer, activeLayer + 1);
+    syncLayerList();
+    setActiveLayer(activeLayer + 1);
+}
+
+void MainWindow::lowerLayer() {
+    if (activeLayer <= 0) return;
+
+    layers.moveLayer(activeLayer, activeLayer - 1);
+    syncLayerList();
+    setActiveLayer(activeLayer - 1);
+}
+
+// Unlike the colour key, the wand only removes the region connected to the click. Further
+// clicks add to the same selection, which lives until another layer is chosen or re-keyed.
+void MainWindow::selectRegionAt(const QPointF& imagePosition) {
+    if (activeLayer < 0) return;
+
+    const LayerStack::Layer& layer = layers.layer(activeLayer);
+    const QPointF local = (imagePosition - layer.position) / layer.scale;
+    const QPoint seed(qFloor(local.x()), qFloor(local.y()));
+    if (!layer.image.rect().contains(seed)) return;
+
+    if (!wand) {
+        wand.reset(new MagicWand(layer.image));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QImage image = layers.takeImage(activeLayer);
+    const QRect region = wand->addSeed(seed, ui->sliderTolerance->value(), image);
+    layers.setImage(activeLayer, image);
+    refreshCanvas();
+
+    statusBar()->showMessage(tr("Magic wand: removed a %1 x %2 region in %3 ms")
+                             .arg(region.width()).arg(region.height()).arg(timer.elapsed()));
+}
+
+void MainWindow::magicWandToggled() {
+    wand.reset();
+    layers.clearPreviews();
+    updateKeyPreview();
+}
+
+void MainWindow::autoCutoutToggled(bool checked) {
+    backgroundLabel->setRectangleMode(checked);
+}
+
+// GrabCut on a proxy of the active layer, seeded from the rectangle drawn on the canvas.
+void MainWindow::cutOutRectangle(const QRectF& imageRect) {
+    ui->btnAutoCut->setChecked(false);
+    if (activeLayer < 0) {
+        QMessageBox::warning(this, tr("Error"), tr("Please load an overlay image first."));
+        return;
+    }
+
+    const LayerStack::Layer& layer = layers.layer(activeLayer);
+    const QRect rect = QRectF((imageRect.topLeft() - layer.position) / layer.scale,
+                              imageRect.size() / layer.scale).toAlignedRect() & layer.image.rect();
+
+    // GrabCut and the full-resolution upsample run on a worker, like the export; the result
+    // is dropped if the layer was removed, reordered or edited in the meantime.
+    const int layerIndex = activeLayer;
+    const QImage source = layer.image;
+    ui->btnAutoCut->setEnabled(false);
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    statusBar()->showMessage(tr("Auto cutout running..."));
+
+    auto* watcher = new QFutureWatcher<CutoutResult>(this);
+    connect(watcher, &QFutureWatcher<CutoutResult>::finished, this, [this, watcher, layerIndex, source]() {
+        watcher->deleteLater();
+        QApplication::restoreOverrideCursor();
+        ui->btnAutoCut->setEnabled(true);
+
+        const CutoutResult cutout = watcher->result();
+        if (cutout.image.isNull()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, tr("Error"), tr("Draw a larger rectangle around the subject."));
+            return;
+        }
+        if (layerIndex >= layers.count() || layers.layer(layerIndex).image.cacheKey() != source.cacheKey()) {
+            statusBar()->showMessage(tr("Auto cutout discarded: the layer changed while it ran."));
+            return;
+        }
+
+        if (layerIndex == activeLayer) wand.reset();
+        layers.setImage(layerIndex, cutout.image);
+        updateKeyPreview();
+
+        const CutoutStats& stats = cutout.stats;
+        statusBar()->showMessage(tr("Auto cutout: %1 GrabCut iterations on a %2 x %3 proxy in %4 ms")
+                                 .arg(stats.iterations).arg(stats.proxySize.width())
+                                 .arg(stats.proxySize.height()).arg(stats.milliseconds));
+    });
+    watcher->setFuture(QtConcurrent::run([source, rect]() {
+        CutoutResult cutout;
+        cutout.image = autoCutout(source, rect, kCutoutBudgetMs, &cutout.stats);
+        return cutout;
+    }));
+}
+
+void MainWindow::updateLayerOpacity(int value) {
+    if (activeLayer < 0) return;
+
+    layers.setOpacity(activeLayer, value / 100.0);
+    refreshCanvas();
+}
+
+void MainWindow::updateLayerMode(int index) {
+    if (activeLayer < 0 || index < 0) return;
+
+    layers.setMode(activeLayer, kBlendModes[index]);
+    updateKeyPreview();
+}
+
+QImage MainWindow::applyKey(const QImage& image) const {
+    if (ui->comboKeyMode->currentIndex() == 0) {
+        return chromaKey(image, selectedColor, ui->sliderTolerance->value());
+    }
+
+    SoftKeySettings settings;
+    settings.key = selectedColor;
+    settings.tolerance = ui->sliderTolerance->value();
+    settings.softness = ui->sliderSoftness->value();
+    settings.spill = ui->sliderSpill->value();
+    return SoftChromaKey(settings).apply(image);
 }
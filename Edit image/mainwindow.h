@@ -4,18 +4,67 @@
 #include <QMainWindow>
 #include <QLabel>
 #include <QPixmap>
+#include <QImage>
 #include <QPoint>
 #include <QColor>
+#include "layerstack.h"
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+class RenditionCache;
+class MagicWand;
+class QRubberBand;
+
 class CustomLabel : public QLabel {
     Q_OBJECT
 public:
     explicit CustomLabel(QWidget* parent = nullptr);
 
+    // Shows image fitted to the label; wheel zoom is then relative to this image.
+    void setSourceImage(const QImage& image);
+    QImage displayImage();
+    QImage sourceImage() const;
+    qreal zoom() const { return scale; }
+    // Where the pixmap is drawn inside the label, as QLabel lays it out.
+    QRect pixmapRect() const;
+
+signals:
+    void renditionShown();
+
+protected:
+    void wheelEvent(QWheelEvent* event) override;
+
+private slots:
+    void renditionReady(const QSize& size, const QImage& image);
+
+private:
+    void showRendition();
+
+    RenditionCache* renditions;
+    qreal scale;
+    QSize displaySize;
+};
+
+// Shows the composite. Clicks select and drag the layer under the cursor, the wheel
+// scales the active layer and Ctrl+wheel zooms the view; positions are in image pixels.
+// In rectangle mode a drag draws a rubber band instead and reports it on release.
+class CanvasLabel : public CustomLabel {
+    Q_OBJECT
+public:
+    explicit CanvasLabel(QWidget* parent = nullptr);
+
+    QPointF toImage(const QPoint& position) const;
+    void setRectangleMode(bool enabled);
+
+signals:
+    void pressed(const QPointF& imagePosition);
+    void dragged(const QPointF& imageDelta);
+    void wheelScaled(qreal factor);
+    void rectangleSelected(const QRectF& imageRect);
+
 protected:
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
@@ -24,8 +73,10 @@ protected:
 
 private:
     bool isDragging;
-    QPoint dragStartPosition;
-    QPoint labelStartPosition;
+    QPoint lastPosition;
+    bool rectangleMode;
+    QPoint rectangleOrigin;
+    QRubberBand* rubberBand;
 };
 
 class MainWindow : public QMainWindow {
@@ -41,16 +92,35 @@ private slots:
     void removeBackground();
     void deleteSelected();
     void saveResult();
+    void exportFullResolution();
     void pickColor();
+    void updateKeyPreview();
+    void backgroundShown();
+    void selectLayerAt(const QPointF& imagePosition);
+    void moveActiveLayer(const QPointF& imageDelta);
+    void scaleActiveLayer(qreal factor);
+    void layerSelectionChanged();
+    void raiseLayer();
+    void lowerLayer();
+    void updateLayerOpacity(int value);
+    void updateLayerMode(int index);
+    void magicWandToggled();
+    void autoCutoutToggled(bool checked);
+    void cutOutRectangle(const QRectF& imageRect);
 
 private:
     Ui::MainWindow *ui;
-    CustomLabel* backgroundLabel;
-    CustomLabel* overlayLabel;
-    QPixmap backgroundPixmap;
-    QPixmap overlayPixmap;
+    CanvasLabel* backgroundLabel;
+    LayerStack layers;
+    int activeLayer;
     QColor selectedColor;
+    std::unique_ptr<MagicWand> wand;
     void initializeUI();
+    void refreshCanvas();
+    void syncLayerList();
+    void setActiveLayer(int index);
+    void selectRegionAt(const QPointF& imagePosition);
+    QImage applyKey(const QImage& image) const;
 };
 
 #endif
@@ -0,0 +1,119 @@
+#include "renditioncache.h"
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+static const int kMaxLevels = 8;
+static const int kMinLevelSide = 64;
+static const int kRecentRenditions = 4;
+
+RenditionCache::RenditionCache(QObject* parent)
+    : QObject(parent)
+    , levelInFlight(false)
+    , generation(0)
+{
+}
+
+void RenditionCache::setSource(const QImage& image) {
+    clear();
+    if (image.isNull()) return;
+
+    levels.append(image);
+    buildNextLevel();
+}
+
+QImage RenditionCache::source() const {
+    return levels.isEmpty() ? QImage() : levels.first();
+}
+
+void RenditionCache::clear() {
+    ++generation;
+    levels.clear();
+    recent.clear();
+    inFlightSize = QSize();
+    pendingSize = QSize();
+    levelInFlight = false;
+}
+
+QImage RenditionCache::rendition(const QSize& size) {
+    if (levels.isEmpty() || size.isEmpty()) return QImage();
+
+    for (int i = 0; i < recent.size(); ++i) {
+        if (recent[i].first == size) {
+            recent.move(i, 0);
+            return recent.first().second;
+        }
+    }
+
+    const QImage& level = levels[levelFor(size)];
+    if (level.size() == size) return level;
+
+    startSmooth(size);
+    return level.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+}
+
+int RenditionCache::levelFor(const QSize& size) const {
+    int best = 0;
+    for (int i = 1; i < levels.size(); ++i) {
+        if (levels[i].width() < size.width() || levels[i].height() < size.height()) break;
+        best = i;
+    }
+    return best;
+}
+
+void RenditionCache::buildNextLevel() {
+    const QImage previous = levels.last();
+    if (levelInFlight || levels.size() >= kMaxLevels ||
+        qMin(previous.width(), previous.height()) / 2 < kMinLevelSide) {
+        return;
+    }
+
+    levelInFlight = true;
+    const quint64 startedGeneration = generation;
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, startedGeneration]() {
+        watcher->deleteLater();
+        if (startedGeneration != generation) return;
+
+        levelInFlight = false;
+        levels.append(watcher->result());
+        buildNextLevel();
+    });
+    watcher->setFuture(QtConcurrent::run([previous]() {
+        return previous.scaled(previous.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }));
+}
+
+void RenditionCache::startSmooth(const QSize& size) {
+    if (inFlightSize.isValid()) {
+        pendingSize = inFlightSize != size ? size : QSize();
+        return;
+    }
+
+    inFlightSize = size;
+    pendingSize = QSize();
+    const QImage level = levels[levelFor(size)];
+    const quint64 startedGeneration = generation;
+
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, size, startedGeneration]() {
+        watcher->deleteLater();
+        if (startedGeneration != generation) return;
+
+        const QImage image = watcher->result();
+        recent.prepend(qMakePair(size, image));
+        while (recent.size() > kRecentRenditions) {
+            recent.removeLast();
+        }
+        inFlightSize = QSize();
+        emit renditionReady(size, image);
+
+        const QSize next = pendingSize;
+        pendingSize = QSize();
+        if (next.isValid()) {
+            rendition(next);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([level, size]() {
+        return level.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }));
+}
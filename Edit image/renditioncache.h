@@ -0,0 +1,42 @@
+#ifndef RENDITIONCACHE_H
+#define RENDITIONCACHE_H
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QSize>
+#include <QVector>
+
+// Scaled copies of one source image for zooming. Halved mip levels are built in the
+// background after setSource(); rendition() answers immediately with a fast scale from the
+// nearest larger level and queues a smooth scale, announced later through renditionReady().
+// Only the latest requested size is worked on, and the last few finished sizes are kept.
+class RenditionCache : public QObject {
+    Q_OBJECT
+public:
+    explicit RenditionCache(QObject* parent = nullptr);
+
+    void setSource(const QImage& image);
+    QImage source() const;
+    void clear();
+
+    QImage rendition(const QSize& size);
+
+signals:
+    void renditionReady(const QSize& size, const QImage& image);
+
+private:
+    int levelFor(const QSize& size) const;
+    void buildNextLevel();
+    void startSmooth(const QSize& size);
+
+    QVector<QImage> levels;
+    QList<QPair<QSize, QImage>> recent;
+    QSize inFlightSize;
+    QSize pendingSize;
+    bool levelInFlight;
+    quint64 generation;
+};
+
+#endif
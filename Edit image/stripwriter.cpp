@@ -0,0 +1,254 @@
+#include "stripwriter.h"
+#include <QByteArray>
+#include <QFileInfo>
+#include <QVector>
+#include <array>
+
+static void put16(QByteArray& buffer, quint32 value) {
+    buffer.append(char(value & 0xFF));
+    buffer.append(char((value >> 8) & 0xFF));
+}
+
+static void put32(QByteArray& buffer, quint32 value) {
+    put16(buffer, value & 0xFFFF);
+    put16(buffer, value >> 16);
+}
+
+static void put32BigEndian(QByteArray& buffer, quint32 value) {
+    buffer.append(char((value >> 24) & 0xFF));
+    buffer.append(char((value >> 16) & 0xFF));
+    buffer.append(char((value >> 8) & 0xFF));
+    buffer.append(char(value & 0xFF));
+}
+
+QImage StripWriter::toRows(const QImage& strip) const {
+    return strip.convertToFormat(channels == 4 ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+}
+
+// Stored (uncompressed) deflate blocks keep the encoder a few dozen lines and let every
+// strip go to disk as soon as it is composited.
+class PngStripWriter : public StripWriter {
+public:
+    bool begin() {
+        static const char signature[8] = {char(0x89), 'P', 'N', 'G', '\r', '\n', char(0x1A), '\n'};
+        file.write(signature, 8);
+
+        QByteArray header;
+        put32BigEndian(header, quint32(imageWidth));
+        put32BigEndian(header, quint32(imageHeight));
+        header.append(char(8));
+        header.append(char(channels == 4 ? 6 : 2));
+        header.append(char(0));
+        header.append(char(0));
+        header.append(char(0));
+        return writeChunk("IHDR", header);
+    }
+
+    bool write(const QImage& strip) override {
+        const QImage rows = toRows(strip);
+        const int rowBytes = imageWidth * channels;
+
+        QByteArray raw;
+        raw.reserve(rows.height() * (rowBytes + 1));
+        for (int y = 0; y < rows.height(); ++y) {
+            raw.append(char(0));
+            raw.append(reinterpret_cast<const char*>(rows.constScanLine(y)), rowBytes);
+        }
+
+        QByteArray data;
+        if (rowsWritten == 0) {
+            data.append(char(0x78));
+            data.append(char(0x01));
+        }
+        appendStoredBlocks(data, raw, false);
+        rowsWritten += rows.height();
+        return writeChunk("IDAT", data);
+    }
+
+    bool finish() override {
+        QByteArray data;
+        appendStoredBlocks(data, QByteArray(), true);
+        put32BigEndian(data, (adlerB << 16) | adlerA);
+        const bool ok = writeChunk("IDAT", data) && writeChunk("IEND", QByteArray());
+        file.close();
+        return ok && rowsWritten == imageHeight;
+    }
+
+private:
+    void appendStoredBlocks(QByteArray& data, const QByteArray& raw, bool final) {
+        qsizetype offset = 0;
+        do {
+            const qsizetype length = qMin<qsizetype>(raw.size() - offset, 65535);
+            data.append(char(final && offset + length == raw.size() ? 1 : 0));
+            put16(data, quint32(length));
+            put16(data, quint32(~length & 0xFFFF));
+            data.append(raw.constData() + offset, length);
+            offset += length;
+        } while (offset < raw.size());
+
+        for (char c : raw) {
+            adlerA = (adlerA + uchar(c)) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+
+    bool writeChunk(const char* type, const QByteArray& data) {
+        QByteArray chunk;
+        put32BigEndian(chunk, quint32(data.size()));
+        chunk.append(type, 4);
+        chunk.append(data);
+
+        quint32 crc = 0xFFFFFFFF;
+        for (qsizetype i = 4; i < chunk.size(); ++i) {
+            crc = crcTable()[(crc ^ uchar(chunk[i])) & 0xFF] ^ (crc >> 8);
+        }
+        put32BigEndian(chunk, crc ^ 0xFFFFFFFF);
+        return file.write(chunk) == chunk.size();
+    }
+
+    // Built by a static initializer, which is thread-safe; exports run on worker threads.
+    static const quint32* crcTable() {
+        static const std::array<quint32, 256> table = [] {
+            std::array<quint32, 256> values;
+            for (quint32 n = 0; n < 256; ++n) {
+                quint32 c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+    quint32 adlerA = 1;
+    quint32 adlerB = 0;
+};
+
+// Baseline uncompressed TIFF; the directory goes at the end, once every strip offset is known.
+class TiffStripWriter : public StripWriter {
+public:
+    bool begin() {
+        rowBytes = quint32(imageWidth) * channels;
+        rowsPerStrip = qMax<quint32>(1, 65536 / rowBytes);
+
+        QByteArray header("II");
+        put16(header, 42);
+        put32(header, 0);
+        return file.write(header) == header.size();
+    }
+
+    bool write(const QImage& strip) override {
+        const QImage rows = toRows(strip);
+        for (int y = 0; y < rows.height(); ++y) {
+            if (file.write(reinterpret_cast<const char*>(rows.constScanLine(y)), rowBytes) != qint64(rowBytes)) {
+                return false;
+            }
+        }
+        rowsWritten += rows.height();
+        return true;
+    }
+
+    bool finish() override {
+        const quint32 dataStart = 8;
+        const quint32 stripCount = (quint32(imageHeight) + rowsPerStrip - 1) / rowsPerStrip;
+
+        QByteArray ifd;
+        quint32 ifdOffset = dataStart + rowBytes * quint32(imageHeight);
+        if (ifdOffset % 2) {
+            ifd.append(char(0));
+            ++ifdOffset;
+        }
+
+        const quint16 entryCount = channels == 4 ? 11 : 10;
+        const quint32 bitsOffset = ifdOffset + 2 + entryCount * 12 + 4;
+        const quint32 offsetsOffset = bitsOffset + 2 * channels;
+        const quint32 countsOffset = offsetsOffset + stripCount * 4;
+
+        QVector<quint32> offsets, counts;
+        for (quint32 s = 0; s < stripCount; ++s) {
+            const quint32 rows = qMin(rowsPerStrip, quint32(imageHeight) - s * rowsPerStrip);
+            offsets.append(dataStart + s * rowsPerStrip * rowBytes);
+            counts.append(rows * rowBytes);
+        }
+
+        auto entry = [&ifd](quint16 tag, quint16 type, quint32 count, quint32 value) {
+            put16(ifd, tag);
+            put16(ifd, type);
+            put32(ifd, count);
+            if (type == 3 && count == 1) {
+                put16(ifd, value);
+                put16(ifd, 0);
+            } else {
+                put32(ifd, value);
+            }
+        };
+
+        put16(ifd, entryCount);
+        entry(256, 4, 1, quint32(imageWidth));
+        entry(257, 4, 1, quint32(imageHeight));
+        entry(258, 3, quint32(channels), bitsOffset);
+        entry(259, 3, 1, 1);
+        entry(262, 3, 1, 2);
+        entry(273, 4, stripCount, stripCount == 1 ? offsets[0] : offsetsOffset);
+        entry(277, 3, 1, quint32(channels));
+        entry(278, 4, 1, rowsPerStrip);
+        entry(279, 4, stripCount, stripCount == 1 ? counts[0] : countsOffset);
+        entry(284, 3, 1, 1);
+        if (channels == 4) {
+            entry(338, 3, 1, 2);   // unassociated alpha
+        }
+        put32(ifd, 0);
+
+        for (int c = 0; c < channels; ++c) put16(ifd, 8);
+        for (quint32 offset : offsets) put32(ifd, offset);
+        for (quint32 count : counts) put32(ifd, count);
+
+        QByteArray offsetBytes;
+        put32(offsetBytes, ifdOffset);
+        const bool ok = file.write(ifd) == ifd.size() && file.seek(4) && file.write(offsetBytes) == 4;
+        file.close();
+        return ok && rowsWritten == imageHeight;
+    }
+
+private:
+    quint32 rowBytes = 0;
+    quint32 rowsPerStrip = 1;
+};
+
+std::unique_ptr<StripWriter> StripWriter::create(const QString& path, int width, int height,
+                                                 bool alpha, QString* error) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    const int channels = alpha ? 4 : 3;
+    std::unique_ptr<StripWriter> writer;
+
+    if (suffix == "png") {
+        writer.reset(new PngStripWriter);
+    } else if (suffix == "tif" || suffix == "tiff") {
+        if (quint64(width) * height * channels > 0xFFFFFFF0ull) {
+            if (error) *error = QObject::tr("The image is larger than 4 GB; export as PNG instead.");
+            return nullptr;
+        }
+        writer.reset(new TiffStripWriter);
+    } else {
+        if (error) *error = QObject::tr("Full-resolution export supports PNG and TIFF.");
+        return nullptr;
+    }
+
+    writer->imageWidth = width;
+    writer->imageHeight = height;
+    writer->channels = channels;
+    writer->file.setFileName(path);
+
+    bool ok = writer->file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (ok) {
+        ok = suffix == "png" ? static_cast<PngStripWriter*>(writer.get())->begin()
+                             : static_cast<TiffStripWriter*>(writer.get())->begin();
+    }
+    if (!ok) {
+        if (error) *error = QObject::tr("Could not write %1.").arg(path);
+        return nullptr;
+    }
+    return writer;
+}
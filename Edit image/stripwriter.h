@@ -0,0 +1,36 @@
+#ifndef STRIPWRITER_H
+#define STRIPWRITER_H
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <memory>
+
+// Writes an image top to bottom, one horizontal strip at a time, so the full-size result
+// never has to exist in memory. PNG (stored deflate blocks, no zlib needed) or baseline TIFF,
+// chosen by extension; RGB, or RGBA when alpha is true.
+//
+// The PNG/TIFF writing is adapted from the strip writer in "Remove background and add any
+// background behind" (stripio.cpp). The apps build separately, so a fix to one belongs in both.
+class StripWriter {
+public:
+    virtual ~StripWriter() = default;
+
+    static std::unique_ptr<StripWriter> create(const QString& path, int width, int height,
+                                               bool alpha, QString* error);
+
+    // strip must be as wide as the image; any format, converted to 8-bit RGB(A).
+    virtual bool write(const QImage& strip) = 0;
+    virtual bool finish() = 0;
+
+protected:
+    QImage toRows(const QImage& strip) const;
+
+    QFile file;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int channels = 3;
+    int rowsWritten = 0;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "tiledexport.h"
+#include "stripwriter.h"
+#include <QFile>
+
+static const qint64 kBandBytes = 32 * 1024 * 1024;
+
+void exportTiled(QPromise<QString>& promise, const QString& path,
+                 const QImage& background, const QList<ExportLayer>& layers) {
+    const int width = background.width();
+    const int height = background.height();
+
+    QString error;
+    std::unique_ptr<StripWriter> writer =
+        StripWriter::create(path, width, height, background.hasAlphaChannel(), &error);
+    if (!writer) {
+        promise.addResult(error);
+        return;
+    }
+
+    const int bandHeight = int(qBound<qint64>(1, kBandBytes / (qint64(width) * 4), height));
+    QImage band(width, bandHeight, QImage::Format_ARGB32_Premultiplied);
+    promise.setProgressRange(0, height);
+
+    for (int y = 0; y < height; y += bandHeight) {
+        if (promise.isCanceled()) {
+            writer.reset();
+            QFile::remove(path);
+            return;
+        }
+
+        const int rows = qMin(bandHeight, height - y);
+        if (rows != band.height()) {
+            band = QImage(width, rows, QImage::Format_ARGB32_Premultiplied);
+        }
+        band.fill(Qt::transparent);
+
+        {
+            QPainter painter(&band);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawImage(QPoint(0, 0), background, QRect(0, y, width, rows));
+
+            // Layers are drawn in background coordinates shifted up by y; the band clips
+            // them, so each band only resamples the part of a layer it actually covers.
+            painter.setRenderHint(QPainter::SmoothPixmapTransform);
+            painter.translate(0, -y);
+            const QRectF bandRect(0, y, width, rows);
+            for (const ExportLayer& layer : layers) {
+                if (layer.image.isNull() || !layer.target.intersects(bandRect)) continue;
+                painter.setOpacity(layer.opacity);
+                painter.setCompositionMode(layer.mode);
+                painter.drawImage(layer.target, layer.image);
+            }
+        }
+
+        if (!writer->write(band)) {
+            writer.reset();
+            QFile::remove(path);
+            promise.addResult(QObject::tr("Could not write %1.").arg(path));
+            return;
+        }
+        promise.setProgressValue(y + rows);
+    }
+
+    promise.addResult(writer->finish() ? QString() : QObject::tr("Could not write %1.").arg(path));
+}
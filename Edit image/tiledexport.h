@@ -0,0 +1,26 @@
+#ifndef TILEDEXPORT_H
+#define TILEDEXPORT_H
+
+#include <QImage>
+#include <QList>
+#include <QPainter>
+#include <QPromise>
+#include <QRectF>
+#include <QString>
+
+// One image placed on the background, in background pixel coordinates.
+struct ExportLayer {
+    QImage image;
+    QRectF target;
+    qreal opacity = 1.0;
+    QPainter::CompositionMode mode = QPainter::CompositionMode_SourceOver;
+};
+
+// Composites layers over background at the background's own resolution and streams the
+// result to path (PNG or TIFF) one band of rows at a time, so only a band is ever held
+// besides the sources. Meant for QtConcurrent::run: progress is reported in rows and a
+// cancel removes the partial file. The result is an error message, empty on success.
+void exportTiled(QPromise<QString>& promise, const QString& path,
+                 const QImage& background, const QList<ExportLayer>& layers);
+
+#endif
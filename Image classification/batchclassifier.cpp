@@ -0,0 +1,157 @@
+#include "batchclassifier.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+static const char *kClasses[] = {"angry", "happy", "relaxed", "sad"};
+
+struct DecodedImage {
+    QByteArray hash;
+    QVector<double> cached;
+    cv::Mat prepared;
+};
+
+static QString csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    return '"' + QString(value).replace("\"", "\"\"") + '"';
+}
+
+BatchClassifier::BatchClassifier(const BatchClassifySettings &settings)
+    : settings(settings)
+    , processed(0)
+    , failed(0)
+    , cached(0)
+    , elapsed(0)
+    , decodeTime(0)
+    , inferenceTime(0)
+{
+}
+
+bool BatchClassifier::run(const std::function<void(int, int)> &progress, const std::atomic<bool> *cancel)
+{
+    processed = failed = cached = 0;
+    decodeTime = inferenceTime = 0;
+    files.clear();
+
+    if (!QDir(settings.inputDir).exists()) {
+        error = "Folderul de intrare nu exista: " + settings.inputDir;
+        return false;
+    }
+    QDirIterator it(settings.inputDir, QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp",
+                    QDir::Files, settings.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+    files.sort();
+
+    OnnxClassifier classifier;
+    if (!classifier.load(settings.modelPath, &error)) return false;
+
+    QFile file(settings.outputCsv);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        error = "Nu s-a putut scrie " + settings.outputCsv;
+        return false;
+    }
+    QTextStream csv(&file);
+    csv << "file,angry,happy,relaxed,sad,predicted,error\n";
+
+    QThreadPool pool;
+    if (settings.threads > 0) {
+        pool.setMaxThreadCount(settings.threads);
+    }
+    const int batchSize = qMax(1, settings.batchSize);
+
+    // Hash-ul se calculeaza tot pe firele de decodare; o imagine gasita in cache nu mai e decodata.
+    ResultCache *cache = settings.cache;
+    const QByteArray modelVersion = cache ? cache->modelVersion(settings.modelPath) : QByteArray();
+    auto decode = [cache, modelVersion](const QString &path) {
+        DecodedImage decoded;
+        if (cache) {
+            decoded.hash = ResultCache::imageHash(path);
+            if (cache->lookup(decoded.hash, modelVersion, &decoded.cached)) return decoded;
+        }
+        const cv::Mat image = OnnxClassifier::readImage(path);
+        if (!image.empty()) decoded.prepared = OnnxClassifier::prepare(image);
+        return decoded;
+    };
+    auto startBatch = [&](int first) {
+        return QtConcurrent::mapped(&pool, files.mid(first, batchSize), decode);
+    };
+
+    QElapsedTimer timer, stage;
+    timer.start();
+
+    QFuture<DecodedImage> next = startBatch(0);
+    for (int first = 0; first < files.size(); first += batchSize) {
+        if (cancel && cancel->load()) break;
+
+        stage.start();
+        const QList<DecodedImage> decoded = next.results();
+        decodeTime += stage.nsecsElapsed() / 1e6;
+        if (first + batchSize < files.size()) {
+            next = startBatch(first + batchSize);
+        }
+
+        std::vector<cv::Mat> prepared;
+        for (const DecodedImage &image : decoded) {
+            if (!image.prepared.empty()) prepared.push_back(image.prepared);
+        }
+
+        stage.start();
+        QVector<QVector<double>> rows;
+        QString batchError;
+        try {
+            rows = classifier.classifyPrepared(prepared);
+        } catch (const cv::Exception &e) {
+            batchError = QString::fromStdString(e.what()).simplified();
+        }
+        const double batchMs = stage.nsecsElapsed() / 1e6;
+        inferenceTime += batchMs;
+
+        int row = 0;
+        for (int i = 0; i < decoded.size(); ++i) {
+            const DecodedImage &image = decoded[i];
+            const QString name = csvField(QDir(settings.inputDir).relativeFilePath(files[first + i]));
+            QVector<double> probabilities = image.cached;
+            if (!probabilities.isEmpty()) {
+                ++cached;
+            } else if (image.prepared.empty() || !batchError.isEmpty()) {
+                csv << name << ",,,,,," << csvField(image.prepared.empty() ? "imaginea nu poate fi citita" : batchError) << "\n";
+                ++failed;
+                continue;
+            } else {
+                probabilities = rows[row++];
+                if (cache) cache->insert(image.hash, modelVersion, probabilities, batchMs / prepared.size());
+            }
+
+            int best = 0;
+            for (int c = 0; c < probabilities.size(); ++c) {
+                if (probabilities[c] > probabilities[best]) best = c;
+            }
+            csv << name;
+            for (double p : probabilities) {
+                csv << ',' << QString::number(p, 'f', 6);
+            }
+            csv << ',' << (best < 4 ? kClasses[best] : "") << ",\n";
+            ++processed;
+        }
+
+        if (progress) progress(processed + failed, files.size());
+    }
+    next.waitForFinished();
+    if (cache) cache->save();
+
+    elapsed = timer.elapsed();
+    return true;
+}
+
+double BatchClassifier::imagesPerSecond() const
+{
+    return elapsed > 0 ? processed * 1000.0 / elapsed : 0.0;
+}
@@ -0,0 +1,57 @@
+#ifndef BATCHCLASSIFIER_H
+#define BATCHCLASSIFIER_H
+
+#include "onnxclassifier.h"
+#include "resultcache.h"
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+
+struct BatchClassifySettings {
+    QString inputDir;
+    QString outputCsv;
+    QString modelPath;
+    int batchSize = 16;
+    int threads = 0;
+    bool recursive = true;
+    ResultCache *cache = nullptr;   // optional; imaginile gasite aici nu mai trec prin retea
+};
+
+// Clasifica toate imaginile unui folder cu modelul ONNX. Citirea si redimensionarea se fac
+// in paralel pe un QThreadPool, pe loturi de batchSize imagini; cat timp un lot trece prin
+// retea (un singur forward pentru tot lotul), urmatorul se citeste deja. Rezultatele se scriu
+// in CSV in ordinea fisierelor.
+class BatchClassifier
+{
+public:
+    explicit BatchClassifier(const BatchClassifySettings &settings);
+
+    // progress(gata, total) este apelat din firul care ruleaza run(); cancel poate opri lucrul
+    // intre loturi.
+    bool run(const std::function<void(int, int)> &progress = nullptr,
+             const std::atomic<bool> *cancel = nullptr);
+
+    QString errorString() const { return error; }
+    int totalCount() const { return files.size(); }
+    int processedCount() const { return processed; }
+    int failedCount() const { return failed; }
+    int cachedCount() const { return cached; }
+    qint64 elapsedMs() const { return elapsed; }
+    double imagesPerSecond() const;
+    double decodeMs() const { return decodeTime; }
+    double inferenceMs() const { return inferenceTime; }
+
+private:
+    BatchClassifySettings settings;
+    QString error;
+    QStringList files;
+    int processed;
+    int failed;
+    int cached;
+    qint64 elapsed;
+    double decodeTime;
+    double inferenceTime;
+};
+
+#endif
@@ -0,0 +1,273 @@
+#include "classificationqueue.h"
+#include "onnxclassifier.h"
+#include "predictionworker.h"
+#include "resultcache.h"
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QTimer>
+#include <QtConcurrent>
+#include <vector>
+
+// Modelele incarcate pentru un fisier ONNX: fiecare lucrare ia unul liber (sau incarca altul)
+// si il pune inapoi la sfarsit. La schimbarea modelului coada trece pe un pool nou, iar cel vechi
+// dispare odata cu ultima lucrare care il mai foloseste.
+class OnnxPool
+{
+public:
+    explicit OnnxPool(const QString &modelPath) : path(modelPath) {}
+
+    std::unique_ptr<OnnxClassifier> acquire(QString *error)
+    {
+        {
+            QMutexLocker lock(&mutex);
+            if (!idle.empty()) {
+                std::unique_ptr<OnnxClassifier> classifier = std::move(idle.back());
+                idle.pop_back();
+                return classifier;
+            }
+        }
+        std::unique_ptr<OnnxClassifier> classifier(new OnnxClassifier);
+        if (!classifier->load(path, error)) return nullptr;
+        return classifier;
+    }
+
+    void release(std::unique_ptr<OnnxClassifier> classifier)
+    {
+        QMutexLocker lock(&mutex);
+        idle.push_back(std::move(classifier));
+    }
+
+    const QString path;
+
+private:
+    QMutex mutex;
+    std::vector<std::unique_ptr<OnnxClassifier>> idle;
+};
+
+ClassificationQueue::ClassificationQueue(PredictionWorker *worker, ResultCache *cache, QObject *parent)
+    : QObject(parent)
+    , worker(worker)
+    , cache(cache)
+    , python(false)
+    , limit(2)
+    , nextId(1)
+    , running(0)
+{
+    threads.setMaxThreadCount(limit);
+    connect(worker, &PredictionWorker::resultReady, this,
+            [this](int request, const QVector<double> &probabilities, double latencyMs, double) {
+        pythonResult(request, probabilities, latencyMs);
+    });
+    connect(worker, &PredictionWorker::failed, this, &ClassificationQueue::pythonFailed);
+}
+
+ClassificationQueue::~ClassificationQueue()
+{
+    blockSignals(true);
+    cancelAll();
+    threads.waitForDone();
+}
+
+bool ClassificationQueue::useOnnx(const QString &modelPath, QString *error)
+{
+    if (!onnxPool || onnxPool->path != modelPath) {
+        auto pool = std::make_shared<OnnxPool>(modelPath);
+        std::unique_ptr<OnnxClassifier> classifier = pool->acquire(error);
+        if (!classifier) return false;
+        pool->release(std::move(classifier));
+        onnxPool = pool;
+    }
+    python = false;
+    return true;
+}
+
+void ClassificationQueue::usePython(const QString &modelPath)
+{
+    pythonModel = modelPath;
+    python = true;
+    worker->start();
+}
+
+void ClassificationQueue::setMaxConcurrent(int count)
+{
+    limit = qMax(1, count);
+    threads.setMaxThreadCount(limit);
+    pump();
+}
+
+// Lucrarea porneste abia din bucla de evenimente, ca apelantul sa aiba deja id-ul cand vin semnalele.
+int ClassificationQueue::submit(const QString &imagePath)
+{
+    Job job;
+    job.id = nextId++;
+    job.path = imagePath;
+    job.python = python;
+    job.modelPath = python ? pythonModel : onnxPool ? onnxPool->path : QString();
+    job.pool = onnxPool;
+    job.cancelled = std::make_shared<std::atomic<bool>>(false);
+    job.timer.start();
+
+    jobs.insert(job.id, job);
+    waiting.append(job.id);
+    QTimer::singleShot(0, this, &ClassificationQueue::pump);
+    return job.id;
+}
+
+void ClassificationQueue::cancel(int id)
+{
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return;
+
+    it->cancelled->store(true);
+    if (!waiting.removeOne(id) && it->request) {
+        // Python nu poate fi intrerupt; raspunsul va fi ignorat de PredictionWorker.
+        worker->cancel(it->request);
+        requests.remove(it->request);
+        --running;
+    }
+    // Altfel firul lucrarii se opreste la urmatoarea etapa, iar locul se elibereaza in readFinished().
+    jobs.erase(it);
+    emit jobCancelled(id);
+    pump();
+}
+
+void ClassificationQueue::cancelAll()
+{
+    const QList<int> queued = waiting;
+    for (int id : queued) {
+        cancel(id);
+    }
+    const QList<int> started = jobs.keys();
+    for (int id : started) {
+        cancel(id);
+    }
+}
+
+void ClassificationQueue::pump()
+{
+    while (running < limit && !waiting.isEmpty()) {
+        start(jobs[waiting.takeFirst()]);
+    }
+}
+
+// Pe fir: versiunea modelului si hash-ul imaginii pentru cache, apoi, cu ONNX, citirea,
+// redimensionarea si inferenta. Cu Python lucrarea se opreste dupa cache, iar cererea se
+// trimite din firul principal.
+void ClassificationQueue::start(Job &job)
+{
+    ++running;
+    const int id = job.id;
+    const QString path = job.path;
+    const QString modelPath = job.modelPath;
+    const bool usesPython = job.python;
+    const std::shared_ptr<OnnxPool> pool = job.pool;
+    const std::shared_ptr<std::atomic<bool>> cancelled = job.cancelled;
+    ResultCache *cache = this->cache;
+
+    auto *watcher = new QFutureWatcher<JobResult>(this);
+    connect(watcher, &QFutureWatcher<JobResult>::finished, this, [this, watcher, id]() {
+        watcher->deleteLater();
+        readFinished(id, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&threads, [this, id, path, modelPath, usesPython, pool, cancelled, cache]() {
+        QElapsedTimer timer;
+        timer.start();
+        JobResult result;
+        if (cache) {
+            result.version = cache->modelVersion(modelPath);
+            result.hash = ResultCache::imageHash(path);
+            if (cache->lookup(result.hash, result.version, &result.probabilities)) {
+                result.cached = true;
+                return result;
+            }
+        }
+        if (usesPython || cancelled->load()) return result;
+        if (!pool) {
+            result.error = tr("Niciun model ONNX încărcat.");
+            return result;
+        }
+
+        const cv::Mat image = OnnxClassifier::readImage(path);
+        if (image.empty()) {
+            result.error = tr("Imaginea nu poate fi citită.");
+            return result;
+        }
+        const cv::Mat prepared = OnnxClassifier::prepare(image);
+        if (cancelled->load()) return result;
+
+        QMetaObject::invokeMethod(this, [this, id]() {
+            if (jobs.contains(id)) emit jobProgress(id, Inference);
+        });
+        std::unique_ptr<OnnxClassifier> classifier = pool->acquire(&result.error);
+        if (!classifier) return result;
+        try {
+            result.probabilities = classifier->classifyPrepared(std::vector<cv::Mat>{prepared}).value(0);
+        } catch (const cv::Exception &e) {
+            result.error = QString::fromStdString(e.what()).simplified();
+        }
+        pool->release(std::move(classifier));
+        result.workMs = timer.nsecsElapsed() / 1e6;
+        return result;
+    }));
+    emit jobProgress(id, Reading);
+}
+
+void ClassificationQueue::readFinished(int id, const JobResult &result)
+{
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        --running;
+        pump();
+        return;
+    }
+
+    it->result = result;
+    if (it->python && !result.cached && result.error.isEmpty()) {
+        // Locul ramane ocupat pana raspunde procesul Python.
+        it->request = worker->classify(it->path);
+        requests.insert(it->request, id);
+        emit jobProgress(id, Inference);
+        return;
+    }
+    if (cache && !result.cached) {
+        cache->insert(result.hash, result.version, result.probabilities, result.workMs);
+    }
+    finish(id);
+}
+
+void ClassificationQueue::finish(int id)
+{
+    const Job job = jobs.take(id);
+    --running;
+    if (job.result.probabilities.isEmpty()) {
+        emit jobFailed(id, job.result.error.isEmpty() ? tr("Modelul nu a întors niciun rezultat.") : job.result.error);
+    } else {
+        emit jobProgress(id, Done);
+        emit jobFinished(id, job.result.probabilities, job.timer.nsecsElapsed() / 1e6, job.result.cached);
+    }
+    pump();
+}
+
+void ClassificationQueue::pythonResult(int request, const QVector<double> &probabilities, double latencyMs)
+{
+    const int id = requests.take(request);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return;
+
+    it->result.probabilities = probabilities;
+    if (cache) {
+        cache->insert(it->result.hash, it->result.version, probabilities, latencyMs);
+    }
+    finish(id);
+}
+
+void ClassificationQueue::pythonFailed(int request, const QString &message)
+{
+    const int id = requests.take(request);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return;
+
+    it->result.probabilities.clear();
+    it->result.error = tr("Eroare la execuția scriptului Python:\n") + message;
+    finish(id);
+}
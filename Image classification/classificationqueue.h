@@ -0,0 +1,98 @@
+#ifndef CLASSIFICATIONQUEUE_H
+#define CLASSIFICATIONQUEUE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+class OnnxPool;
+class PredictionWorker;
+class ResultCache;
+
+// Coada de clasificari a ferestrei: submit() intoarce imediat un id, iar cel mult
+// maxConcurrent() lucrari ruleaza odata, restul asteapta in ordinea trimiterii. Citirea,
+// hash-ul pentru cache si inferenta ONNX se fac pe fire separate, fiecare lucrare cu un model
+// din cele pastrate in OnnxPool (un cv::dnn::Net nu poate rula pe doua fire deodata); cu
+// Python, inferenta merge la PredictionWorker. O lucrare anulata cat asteapta nu mai porneste;
+// una pornita se opreste la urmatoarea etapa, iar rezultatul ei nu mai este anuntat.
+class ClassificationQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage { Queued, Reading, Inference, Done };
+
+    ClassificationQueue(PredictionWorker *worker, ResultCache *cache, QObject *parent = nullptr);
+    ~ClassificationQueue();
+
+    // Incarca modelul o data aici, ca o cale gresita sa fie raportata inainte de prima lucrare.
+    bool useOnnx(const QString &modelPath, QString *error);
+    // modelPath este fisierul incarcat de predict.py; serveste doar ca versiune in cache.
+    void usePython(const QString &modelPath);
+
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const { return limit; }
+
+    int submit(const QString &imagePath);
+    void cancel(int id);
+    void cancelAll();
+
+signals:
+    void jobProgress(int id, int stage);
+    // latencyMs: de la submit() pana la rezultat, inclusiv asteptarea in coada.
+    void jobFinished(int id, const QVector<double> &probabilities, double latencyMs, bool fromCache);
+    void jobFailed(int id, const QString &message);
+    void jobCancelled(int id);
+
+private:
+    struct JobResult {
+        QVector<double> probabilities;
+        QByteArray hash;
+        QByteArray version;
+        double workMs = 0;
+        bool cached = false;
+        QString error;
+    };
+
+    struct Job {
+        int id;
+        QString path;
+        QString modelPath;
+        bool python;
+        std::shared_ptr<OnnxPool> pool;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        QElapsedTimer timer;
+        int request = 0;   // id-ul cererii din PredictionWorker, dupa trimitere
+        JobResult result;
+    };
+
+    void pump();
+    void start(Job &job);
+    void readFinished(int id, const JobResult &result);
+    void finish(int id);
+    void pythonResult(int request, const QVector<double> &probabilities, double latencyMs);
+    void pythonFailed(int request, const QString &message);
+
+    PredictionWorker *worker;
+    ResultCache *cache;
+    QThreadPool threads;
+    std::shared_ptr<OnnxPool> onnxPool;
+    QString pythonModel;
+    bool python;
+    int limit;
+    int nextId;
+    QMap<int, Job> jobs;
+    QList<int> waiting;
+    int running;
+    QHash<int, int> requests;   // cerere PredictionWorker -> lucrare
+};
+
+#endif
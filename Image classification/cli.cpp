@@ -0,0 +1,367 @@
+#include "cli.h"
+#include "batchclassifier.h"
+#include "onnxclassifier.h"
+#include "predictionworker.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QMap>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+static const char *kPythonScript = "C:/openCV/project/T01/predict.py";
+static const char *kOnnxModel = "C:/openCV/project/T01/dog_emotion_model.onnx";
+static const char *kOnnxInt8Model = "C:/openCV/project/T01/dog_emotion_model_int8.onnx";
+static const int kPythonTimeoutMs = 300000;
+
+bool isHeadlessInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--parity") == 0 || std::strcmp(argv[i], "--latency") == 0 ||
+            std::strcmp(argv[i], "--batch") == 0 || std::strcmp(argv[i], "--quant-report") == 0) return true;
+    }
+    return false;
+}
+
+static QStringList imageFiles(const QString &input)
+{
+    if (QFileInfo(input).isFile()) return QStringList() << input;
+
+    QStringList files;
+    QDirIterator it(input, QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+    files.sort();
+    return files;
+}
+
+// Trimite toate imaginile procesului Python si asteapta raspunsurile (cel mult
+// kPythonTimeoutMs, ca un Python lipsa sa nu blocheze la nesfarsit).
+static QMap<int, QVector<double>> pythonPredictions(PredictionWorker &worker, const QStringList &files,
+                                                    QMap<int, double> *latencies = nullptr)
+{
+    QMap<int, int> fileForRequest;
+    QMap<int, QVector<double>> results;
+    int pending = files.size();
+
+    QEventLoop loop;
+    QObject::connect(&worker, &PredictionWorker::resultReady, &loop,
+                     [&](int id, const QVector<double> &probabilities, double latencyMs, double) {
+        if (!fileForRequest.contains(id)) return;
+        results.insert(fileForRequest.value(id), probabilities);
+        if (latencies) latencies->insert(fileForRequest.value(id), latencyMs);
+        if (--pending == 0) loop.quit();
+    });
+    // Un id necunoscut nu este pus pe seama fisierului 0.
+    QObject::connect(&worker, &PredictionWorker::failed, &loop, [&](int id, const QString &message) {
+        if (!fileForRequest.contains(id)) return;
+        QTextStream(stderr) << files.value(fileForRequest.value(id)) << ": " << message << "\n";
+        if (--pending == 0) loop.quit();
+    });
+
+    for (int i = 0; i < files.size(); ++i) {
+        fileForRequest.insert(worker.classify(files[i]), i);
+    }
+    QTimer::singleShot(kPythonTimeoutMs, &loop, &QEventLoop::quit);
+    if (pending > 0) loop.exec();
+    return results;
+}
+
+// Compara iesirea cv::dnn cu predict.py pe aceleasi imagini; esueaza daca o probabilitate
+// difera cu mai mult decat toleranta sau daca clasa castigatoare difera.
+static int runParity(const QStringList &files, double tolerance, const QString &modelPath)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    OnnxClassifier classifier;
+    QString error;
+    if (!classifier.load(modelPath, &error)) {
+        err << "Eroare: " << error << "\n";
+        return 2;
+    }
+
+    PredictionWorker worker(kPythonScript);
+    worker.start();
+    const QMap<int, QVector<double>> python = pythonPredictions(worker, files);
+
+    int compared = 0, mismatches = 0;
+    double worst = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        if (!python.contains(i)) continue;
+        const QVector<double> reference = python.value(i);
+        const QVector<double> onnx = classifier.classify(files[i]);
+        if (onnx.size() != reference.size()) {
+            err << files[i] << ": iesiri de marimi diferite\n";
+            ++mismatches;
+            continue;
+        }
+
+        double difference = 0;
+        for (int c = 0; c < onnx.size(); ++c) {
+            difference = qMax(difference, std::abs(onnx[c] - reference[c]));
+        }
+        const bool sameClass = std::max_element(onnx.begin(), onnx.end()) - onnx.begin() ==
+                               std::max_element(reference.begin(), reference.end()) - reference.begin();
+        if (difference > tolerance || !sameClass) {
+            out << "  " << files[i] << ": diferenta " << difference << (sameClass ? "" : ", alta clasa") << "\n";
+            ++mismatches;
+        }
+        worst = qMax(worst, difference);
+        ++compared;
+    }
+
+    out << compared << " imagini comparate, diferenta maxima " << worst << ", " << mismatches
+        << " peste toleranta " << tolerance << "\n";
+    return compared > 0 && mismatches == 0 ? 0 : 3;
+}
+
+static QString summary(QVector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    const double median = times[times.size() / 2];
+    const double p95 = times[qMin(int(times.size() * 0.95), int(times.size()) - 1)];
+    return QString("mediana %1 ms, p95 %2 ms").arg(median, 0, 'f', 2).arg(p95, 0, 'f', 2);
+}
+
+// Rece: de la pornire (incarcarea modelului) pana la primul rezultat. Cald: cereri repetate
+// pe modelul deja incarcat.
+static int runLatency(const QString &imagePath, int runs, const QString &modelPath)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QElapsedTimer timer;
+    timer.start();
+    OnnxClassifier classifier;
+    QString error;
+    if (!classifier.load(modelPath, &error)) {
+        err << "Eroare: " << error << "\n";
+        return 2;
+    }
+    if (classifier.classify(imagePath).isEmpty()) {
+        err << "Eroare: imaginea nu poate fi citita: " << imagePath << "\n";
+        return 2;
+    }
+    out << "ONNX (cv::dnn)   rece " << QString::number(timer.nsecsElapsed() / 1e6, 'f', 1) << " ms, ";
+
+    QVector<double> warm;
+    for (int i = 0; i < runs; ++i) {
+        timer.start();
+        classifier.classify(imagePath);
+        warm.append(timer.nsecsElapsed() / 1e6);
+    }
+    out << "cald " << summary(warm) << "\n";
+    out.flush();
+
+    timer.start();
+    PredictionWorker worker(kPythonScript);
+    worker.start();
+    if (pythonPredictions(worker, QStringList() << imagePath).isEmpty()) {
+        err << "Eroare: predict.py --serve nu a raspuns\n";
+        return 2;
+    }
+    out << "Python (TF)      rece " << QString::number(timer.nsecsElapsed() / 1e6, 'f', 1) << " ms, ";
+
+    // O cerere pe rand, ca la ONNX; trimise toate odata, fiecare ar astepta si inferentele
+    // din fata ei.
+    QVector<double> pythonWarm;
+    for (int i = 0; i < runs; ++i) {
+        QMap<int, double> latencies;
+        pythonPredictions(worker, QStringList() << imagePath, &latencies);
+        if (latencies.contains(0)) pythonWarm.append(latencies.value(0));
+    }
+    out << "cald " << (pythonWarm.isEmpty() ? QString("-") : summary(pythonWarm)) << "\n";
+    return 0;
+}
+
+static int argMax(const QVector<double> &values)
+{
+    return int(std::max_element(values.begin(), values.end()) - values.begin());
+}
+
+// Compara modelul INT8 cu cel FP32 pe folderul de validare (subfoldere angry, happy,
+// relaxed, sad, ca la flow_from_directory): marimea fisierului, latenta la cald pe o imagine
+// si acuratetea, plus cat de des cele doua modele dau aceeasi clasa.
+static int runQuantReport(const QString &valDir, int runs)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    static const QStringList classes = {"angry", "happy", "relaxed", "sad"};
+    std::vector<cv::Mat> images;
+    QVector<int> labels;
+    for (const QString &file : imageFiles(valDir)) {
+        const int label = classes.indexOf(QFileInfo(file).dir().dirName().toLower());
+        const cv::Mat image = OnnxClassifier::readImage(file);
+        if (label < 0 || image.empty()) continue;
+        images.push_back(OnnxClassifier::prepare(image));
+        labels.append(label);
+    }
+    if (images.empty()) {
+        err << "Nu exista imagini etichetate in " << valDir << "\n";
+        return 1;
+    }
+
+    const QString models[] = {kOnnxModel, kOnnxInt8Model};
+    QVector<int> predictions[2];
+    out << images.size() << " imagini de validare\n"
+        << "model   marime MB   latenta mediana ms   acuratete\n";
+    for (int m = 0; m < 2; ++m) {
+        OnnxClassifier classifier;
+        QString error;
+        if (!classifier.load(models[m], &error)) {
+            err << "Eroare: " << error << "\n";
+            return 2;
+        }
+
+        QVector<double> times;
+        QElapsedTimer timer;
+        for (int i = 0; i < runs + 1; ++i) {
+            timer.start();
+            classifier.classifyPrepared(std::vector<cv::Mat>{images.front()});
+            if (i > 0) times.append(timer.nsecsElapsed() / 1e6);
+        }
+        std::sort(times.begin(), times.end());
+
+        int correct = 0;
+        for (size_t first = 0; first < images.size(); first += 16) {
+            const std::vector<cv::Mat> batch(images.begin() + first, images.begin() + qMin(first + 16, images.size()));
+            for (const QVector<double> &row : classifier.classifyPrepared(batch)) {
+                predictions[m].append(argMax(row));
+                if (predictions[m].last() == labels[predictions[m].size() - 1]) ++correct;
+            }
+        }
+
+        out << QString("%1 %2 %3 %4%\n")
+                   .arg(m == 0 ? "FP32" : "INT8", -7)
+                   .arg(QFileInfo(models[m]).size() / 1e6, 9, 'f', 2)
+                   .arg(times[times.size() / 2], 20, 'f', 2)
+                   .arg(correct * 100.0 / images.size(), 10, 'f', 2);
+    }
+
+    int agree = 0;
+    for (int i = 0; i < predictions[0].size(); ++i) {
+        if (predictions[0][i] == predictions[1][i]) ++agree;
+    }
+    out << "Aceeasi clasa FP32/INT8: " << QString::number(agree * 100.0 / predictions[0].size(), 'f', 2) << "%\n";
+    return 0;
+}
+
+// Fiecare marime de lot ruleaza pe tot folderul; CSV-ul ramane cel al ultimei rulari.
+static int runBatch(BatchClassifySettings settings, const QList<int> &batchSizes)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    int failed = 0;
+    for (int batchSize : batchSizes) {
+        settings.batchSize = batchSize;
+        BatchClassifier classifier(settings);
+        if (!classifier.run()) {
+            err << "Eroare: " << classifier.errorString() << "\n";
+            return 2;
+        }
+        out << "lot " << batchSize << ": " << classifier.processedCount() << "/" << classifier.totalCount()
+            << " imagini in " << classifier.elapsedMs() << " ms ("
+            << QString::number(classifier.imagesPerSecond(), 'f', 1) << " imagini/s; asteptare citire "
+            << QString::number(classifier.decodeMs(), 'f', 0) << " ms, inferenta "
+            << QString::number(classifier.inferenceMs(), 'f', 0) << " ms), " << classifier.cachedCount()
+            << " din cache, " << classifier.failedCount() << " erori\n";
+        out.flush();
+        failed = classifier.failedCount();
+    }
+
+    if (settings.cache) {
+        const ResultCache::Stats stats = settings.cache->stats();
+        const int lookups = stats.hits + stats.misses;
+        out << "cache: " << stats.hits << "/" << lookups << " potriviri ("
+            << QString::number(lookups > 0 ? stats.hits * 100.0 / lookups : 0.0, 'f', 1) << "%), ~"
+            << QString::number(stats.savedMs, 'f', 0) << " ms de inferenta economisite, "
+            << settings.cache->size() << " intrari\n";
+    }
+    return failed == 0 ? 0 : 3;
+}
+
+int runHeadless(const QStringList& arguments)
+{
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Clasificare fara interfata grafica.");
+    parser.addHelpOption();
+
+    QCommandLineOption parityOption("parity", "Compara cv::dnn cu predict.py pe o imagine sau un folder.");
+    QCommandLineOption latencyOption("latency", "Masoara latenta la rece si la cald pentru ONNX si Python.");
+    QCommandLineOption batchOption("batch", "Clasifica toate imaginile unui folder in CSV, pe loturi.");
+    QCommandLineOption inputOption(QStringList() << "i" << "input", "Imaginea sau folderul de intrare.", "cale");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Fisierul CSV al lui --batch.", "fisier",
+                                    "classification.csv");
+    QCommandLineOption batchSizeOption("batch-size",
+        "Imagini pe forward la --batch; mai multe valori separate prin virgula compara viteza.", "n", "16");
+    QCommandLineOption threadsOption("threads", "Fire pentru citirea imaginilor (0 = toate nucleele).", "n", "0");
+    QCommandLineOption cacheOption("cache",
+        "La --batch, refoloseste rezultatele salvate pentru imaginile deja clasificate cu acelasi model.");
+    QCommandLineOption int8Option("int8", "Foloseste modelul cuantizat INT8 (quantize.py).");
+    QCommandLineOption quantReportOption("quant-report",
+        "Compara INT8 cu FP32 (marime, latenta, acuratete) pe folderul de validare.");
+    QCommandLineOption toleranceOption("tolerance", "Diferenta maxima acceptata la --parity.", "valoare", "0.001");
+    QCommandLineOption runsOption("runs", "Numarul de rulari la cald pentru --latency.", "n", "50");
+
+    parser.addOptions({parityOption, latencyOption, batchOption, quantReportOption, inputOption, outputOption,
+                       batchSizeOption, threadsOption, cacheOption, int8Option, toleranceOption, runsOption});
+    parser.process(arguments);
+
+    if (!parser.isSet(inputOption)) {
+        err << "Trebuie specificat --input.\n";
+        return 1;
+    }
+    const QString modelPath = parser.isSet(int8Option) ? kOnnxInt8Model : kOnnxModel;
+
+    if (parser.isSet(quantReportOption)) {
+        return runQuantReport(parser.value(inputOption), qMax(1, parser.value(runsOption).toInt()));
+    }
+
+    if (parser.isSet(batchOption)) {
+        BatchClassifySettings settings;
+        settings.inputDir = parser.value(inputOption);
+        settings.outputCsv = parser.value(outputOption);
+        settings.modelPath = modelPath;
+        settings.threads = qMax(0, parser.value(threadsOption).toInt());
+        std::unique_ptr<ResultCache> cache;
+        if (parser.isSet(cacheOption)) {
+            cache.reset(new ResultCache);
+            settings.cache = cache.get();
+        }
+
+        QList<int> batchSizes;
+        for (const QString &size : parser.value(batchSizeOption).split(',', Qt::SkipEmptyParts)) {
+            if (size.toInt() > 0) batchSizes << size.toInt();
+        }
+        if (batchSizes.isEmpty()) {
+            err << "--batch-size trebuie sa fie un numar pozitiv.\n";
+            return 1;
+        }
+        return runBatch(settings, batchSizes);
+    }
+
+    if (parser.isSet(parityOption)) {
+        const QStringList files = imageFiles(parser.value(inputOption));
+        if (files.isEmpty()) {
+            err << "Nu exista imagini in " << parser.value(inputOption) << "\n";
+            return 1;
+        }
+        return runParity(files, parser.value(toleranceOption).toDouble(), modelPath);
+    }
+
+    return runLatency(parser.value(inputOption), qMax(1, parser.value(runsOption).toInt()), modelPath);
+}
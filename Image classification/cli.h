@@ -0,0 +1,10 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <QStringList>
+
+// Modurile fara interfata grafica, pornite din linia de comanda.
+bool isHeadlessInvocation(int argc, char *argv[]);
+int runHeadless(const QStringList& arguments);
+
+#endif
@@ -0,0 +1,20 @@
+import os
+import sys
+import warnings
+warnings.filterwarnings('ignore')
+os.environ['TF_CPP_MIN_LOG_LEVEL'] = '3'
+
+import tensorflow as tf
+import tf2onnx
+
+# Exporta modelul Keras in ONNX pentru cv::dnn. Intrarea devine NCHW (1x3x150x150),
+# exact ce produce cv::dnn::blobFromImage, iar softmax-ul ramane ultimul strat.
+model_path = sys.argv[1] if len(sys.argv) > 1 else "C:/openCV/project/T01/dog_emotion_model.h5"
+onnx_path = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(model_path)[0] + ".onnx"
+
+model = tf.keras.models.load_model(model_path, compile=False)
+spec = (tf.TensorSpec((None, 150, 150, 3), tf.float32, name="input"),)
+tf2onnx.convert.from_keras(model, input_signature=spec, opset=13,
+                           inputs_as_nchw=["input"], output_path=onnx_path)
+
+print(f"Exported {model_path} -> {onnx_path}")
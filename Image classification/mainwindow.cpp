@@ -1,11 +1,31 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "predictionworker.h"
+#include "batchclassifier.h"
+#include "classificationqueue.h"
+#include "webcamclassifier.h"
+#include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
-#include <QProcess>
+#include <QLabel>
+#include <QProgressBar>
+#include <QStatusBar>
+#include <QtConcurrent>
+#include <algorithm>
+
+static const QStringList kClasses = {"Angry", "Happy", "Relaxed", "Sad"};
+static const char *kOnnxModel = "C:/openCV/project/T01/dog_emotion_model.onnx";
+static const char *kOnnxInt8Model = "C:/openCV/project/T01/dog_emotion_model_int8.onnx";
+static const char *kPythonModel = "C:/openCV/project/T01/dog_emotion_model.h5";
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
+    , worker(new PredictionWorker("C:/openCV/project/T01/predict.py", this))
+    , queue(new ClassificationQueue(worker, &cache, this))
+    , webcam(new WebcamClassifier(this))
+    , cacheLabel(new QLabel(this))
+    , folderCancel(false)
 {
     ui->setupUi(this);
     setWindowTitle("Computer Vision 2024-2025 © Dodoc Ionuț-Daniel");
@@ -14,78 +34,285 @@ MainWindow::MainWindow(QWidget *parent)
     qDebug() << "Setting window icon from:" << iconPath;
     setWindowIcon(QIcon(iconPath));
 
+    statusBar()->addPermanentWidget(cacheLabel);
+    updateCacheLabel();
+
     connect(ui->loadImageButton, &QPushButton::clicked, this, &MainWindow::loadImage);
     connect(ui->predictButton, &QPushButton::clicked, this, &MainWindow::classifyImage);
+    connect(ui->classifyFolderButton, &QPushButton::clicked, this, &MainWindow::classifyFolder);
+    connect(&folderWatcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, &MainWindow::folderClassified);
+    connect(ui->webcamButton, &QPushButton::toggled, this, &MainWindow::toggleWebcam);
+    connect(webcam, &WebcamClassifier::frameReady, this, &MainWindow::showWebcamFrame);
+    connect(webcam, &WebcamClassifier::predictionUpdated, this, &MainWindow::showWebcamPrediction);
+    connect(webcam, &WebcamClassifier::failed, this, &MainWindow::webcamFailed);
+    connect(ui->cancelJobsButton, &QPushButton::clicked, this, &MainWindow::cancelSelectedJobs);
+    connect(ui->cancelAllButton, &QPushButton::clicked, queue, &ClassificationQueue::cancelAll);
+    connect(ui->concurrencySpinBox, &QSpinBox::valueChanged, queue, &ClassificationQueue::setMaxConcurrent);
+    queue->setMaxConcurrent(ui->concurrencySpinBox->value());
+
+    connect(queue, &ClassificationQueue::jobProgress, this, &MainWindow::showJobProgress);
+    connect(queue, &ClassificationQueue::jobFinished, this, &MainWindow::showJobResult);
+    connect(queue, &ClassificationQueue::jobFailed, this, &MainWindow::showJobError);
+    connect(queue, &ClassificationQueue::jobCancelled, this, &MainWindow::showJobCancelled);
+    connect(worker, &PredictionWorker::stateChanged, this, [this](const QString &message) {
+        statusBar()->showMessage(message);
+    });
+
+    // Modelul ales se incarca de la pornire, ca prima clasificare sa nu astepte.
+    connect(ui->backendComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::backendChanged);
+    backendChanged(ui->backendComboBox->currentIndex());
 }
 
+// Daca modelul ONNX lipseste (export_onnx.py sau quantize.py nu a fost rulat), se trece pe Python.
+void MainWindow::backendChanged(int index)
+{
+    if (index == PythonBackend) {
+        queue->usePython(kPythonModel);
+        return;
+    }
+
+    // Lucrarile deja trimise raman pe modelul cu care au fost trimise.
+    QString error;
+    if (!queue->useOnnx(index == OnnxInt8Backend ? kOnnxInt8Model : kOnnxModel, &error)) {
+        statusBar()->showMessage(error);
+        ui->backendComboBox->setCurrentIndex(PythonBackend);
+        return;
+    }
+    statusBar()->showMessage(index == OnnxInt8Backend ? tr("Model ONNX INT8 încărcat.") : tr("Model ONNX încărcat."));
+}
+
+// Coada si lotul din classifyFolder() folosesc cache-ul din firele lor, deci trebuie oprite
+// inainte ca membrul cache sa dispara; camera se opreste tot aici, cat fereastra inca exista.
 MainWindow::~MainWindow()
 {
+    folderCancel = true;
+    folderWatcher.waitForFinished();
+    delete webcam;
+    delete queue;
     delete ui;
 }
 
 void MainWindow::loadImage()
 {
-    imagePath = QFileDialog::getOpenFileName(this, tr("Încărcați imagine"), "", tr("Imagini (*.png *.jpg *.bmp)"));
-    if (!imagePath.isEmpty()) {
-        ui->imageLabel->setPixmap(QPixmap(imagePath).scaled(200, 200, Qt::KeepAspectRatio));
+    imagePaths = QFileDialog::getOpenFileNames(this, tr("Încărcați imagini"), "", tr("Imagini (*.png *.jpg *.bmp)"));
+    if (!imagePaths.isEmpty()) {
+        ui->imageLabel->setPixmap(QPixmap(imagePaths.last()).scaled(200, 200, Qt::KeepAspectRatio));
+        statusBar()->showMessage(tr("%1 imagini selectate.").arg(imagePaths.size()));
     } else {
         QMessageBox::warning(this, tr("Eroare"), tr("Nu ați selectat nicio imagine."));
     }
 }
 
+// Fiecare imagine selectata devine o lucrare in coada si un rand in tabel; rezultatele apar
+// pe rand, pe masura ce se termina, fara ca fereastra sa astepte.
 void MainWindow::classifyImage()
 {
-    if (imagePath.isEmpty()) {
+    if (imagePaths.isEmpty()) {
         QMessageBox::warning(this, tr("Eroare"), tr("Încărcați mai întâi o imagine."));
         return;
     }
 
-    QProcess process;
-    QString pythonScript = "C:/openCV/project/T01/predict.py";
+    for (const QString &path : std::as_const(imagePaths)) {
+        const int id = queue->submit(path);
+        const int row = ui->jobsTable->rowCount();
+        ui->jobsTable->insertRow(row);
 
-    if (!QFile::exists(pythonScript)) {
-        QMessageBox::critical(this, tr("Eroare"),
-                              tr("Scriptul Python nu a fost găsit la calea: ") + pythonScript);
-        return;
+        auto *name = new QTableWidgetItem(QFileInfo(path).fileName());
+        name->setData(Qt::UserRole, id);
+        name->setData(Qt::UserRole + 1, path);
+        name->setToolTip(path);
+        ui->jobsTable->setItem(row, 0, name);
+        ui->jobsTable->setCellWidget(row, 1, new QProgressBar);
+        ui->jobsTable->setItem(row, 2, new QTableWidgetItem);
+        jobRows.insert(id, row);
+        setJobState(id, 0, tr("În așteptare"));
     }
+    ui->resultLabel->setText(tr("Se clasifică..."));
+}
 
-    QStringList arguments;
-    arguments << pythonScript << imagePath;
+void MainWindow::cancelSelectedJobs()
+{
+    const QList<QTableWidgetItem *> selected = ui->jobsTable->selectedItems();
+    for (QTableWidgetItem *item : selected) {
+        if (item->column() == 0) queue->cancel(item->data(Qt::UserRole).toInt());
+    }
+}
 
-    qDebug() << "Executing command: python" << arguments;
+void MainWindow::setJobState(int id, int percent, const QString &state, const QString &result)
+{
+    const int row = jobRows.value(id, -1);
+    if (row < 0) return;
+
+    auto *bar = static_cast<QProgressBar *>(ui->jobsTable->cellWidget(row, 1));
+    bar->setValue(percent);
+    bar->setFormat(state);
+    if (!result.isNull()) ui->jobsTable->item(row, 2)->setText(result);
+}
+
+void MainWindow::showJobProgress(int id, int stage)
+{
+    if (stage == ClassificationQueue::Reading) {
+        setJobState(id, 33, tr("Citire"));
+    } else if (stage == ClassificationQueue::Inference) {
+        setJobState(id, 66, tr("Inferență"));
+    }
+}
+
+void MainWindow::showJobResult(int id, const QVector<double> &probabilities, double latencyMs, bool fromCache)
+{
+    QString summary;
+    if (probabilities.size() == kClasses.size()) {
+        const int best = int(std::max_element(probabilities.begin(), probabilities.end()) - probabilities.begin());
+        summary = QString("%1 (%2%)").arg(kClasses[best]).arg(probabilities[best] * 100, 0, 'f', 1);
+    }
+    setJobState(id, 100, fromCache ? tr("Gata (din cache)") : tr("Gata"), summary);
+
+    const int row = jobRows.value(id, -1);
+    if (row >= 0) {
+        const QString path = ui->jobsTable->item(row, 0)->data(Qt::UserRole + 1).toString();
+        ui->imageLabel->setPixmap(QPixmap(path).scaled(200, 200, Qt::KeepAspectRatio));
+    }
+    showProbabilities(probabilities, latencyMs, fromCache);
+    updateCacheLabel();
+}
 
-    process.start("python", arguments);
+void MainWindow::showJobError(int id, const QString &message)
+{
+    setJobState(id, 0, tr("Eroare"), message.section('\n', 0, 0));
+    const int row = jobRows.value(id, -1);
+    if (row >= 0) ui->jobsTable->item(row, 2)->setToolTip(message);
+    statusBar()->showMessage(message);
+    updateCacheLabel();
+}
 
-    if (!process.waitForFinished(30000)) {
-        QMessageBox::critical(this, tr("Eroare"),
-                              tr("Timeout la execuția scriptului Python."));
+void MainWindow::showJobCancelled(int id)
+{
+    setJobState(id, 0, tr("Anulată"));
+}
+
+// Lotul ruleaza pe un fir separat, cu propriul model ONNX (INT8 daca acesta e ales);
+// progresul apare in bara de stare. Cat timp ruleaza, butonul il anuleaza dupa lotul curent.
+void MainWindow::classifyFolder()
+{
+    if (folderWatcher.isRunning()) {
+        folderCancel = true;
+        ui->classifyFolderButton->setEnabled(false);
+        statusBar()->showMessage(tr("Se anulează clasificarea folderului..."));
         return;
     }
 
-    QString output = process.readAllStandardOutput();
-    QString error = process.readAllStandardError();
-
-    qDebug() << "Process exit code:" << process.exitCode();
-    qDebug() << "Process exit status:" << process.exitStatus();
-    qDebug() << "Standard output:" << output;
-    qDebug() << "Standard error:" << error;
-
-    if (process.exitCode() != 0 || !error.isEmpty()) {
-        QString errorMessage = tr("Eroare la execuția scriptului Python:\n");
-        if (!error.isEmpty()) {
-            errorMessage += error;
-        } else {
-            errorMessage += output;
-        }
-        QMessageBox::critical(this, tr("Eroare"), errorMessage);
+    const QString folder = QFileDialog::getExistingDirectory(this, tr("Alegeți folderul cu imagini"));
+    if (folder.isEmpty()) return;
+    const QString csvPath = QFileDialog::getSaveFileName(this, tr("Salvați rezultatele"),
+                                                         QDir(folder).filePath("classification.csv"),
+                                                         tr("CSV (*.csv)"));
+    if (csvPath.isEmpty()) return;
+
+    BatchClassifySettings settings;
+    settings.inputDir = folder;
+    settings.outputCsv = csvPath;
+    settings.modelPath = ui->backendComboBox->currentIndex() == OnnxInt8Backend ? kOnnxInt8Model : kOnnxModel;
+    settings.cache = &cache;
+
+    folderCancel = false;
+    ui->classifyFolderButton->setText(tr("Anulează folderul"));
+    folderWatcher.setFuture(QtConcurrent::run([this, settings]() {
+        BatchClassifier classifier(settings);
+        const bool ok = classifier.run([this](int done, int total) {
+            QMetaObject::invokeMethod(this, [this, done, total]() {
+                statusBar()->showMessage(tr("Clasificare folder: %1/%2").arg(done).arg(total));
+            });
+        }, &folderCancel);
+        if (!ok) return qMakePair(false, classifier.errorString());
+        return qMakePair(true, tr("%1 imagini clasificate (%2 imagini/s, %3 din cache), %4 erori.")
+                                   .arg(classifier.processedCount())
+                                   .arg(classifier.imagesPerSecond(), 0, 'f', 1)
+                                   .arg(classifier.cachedCount())
+                                   .arg(classifier.failedCount()));
+    }));
+}
+
+void MainWindow::folderClassified()
+{
+    ui->classifyFolderButton->setText(tr("Clasifică un folder..."));
+    ui->classifyFolderButton->setEnabled(true);
+    updateCacheLabel();
+    const QPair<bool, QString> result = folderWatcher.result();
+    if (!result.first) {
+        QMessageBox::critical(this, tr("Eroare"), result.second);
+    }
+    statusBar()->showMessage(folderCancel ? tr("Anulat: ") + result.second : result.second);
+}
+
+// Camera foloseste modelul ONNX ales (FP32 daca backend-ul este Python), pe firul ei.
+void MainWindow::toggleWebcam(bool on)
+{
+    if (!on) {
+        webcam->stop();
+        statusBar()->showMessage(tr("Camera oprită."));
         return;
     }
 
-    if (output.trimmed().isEmpty()) {
-        QMessageBox::warning(this, tr("Eroare"),
-                             tr("Nu s-a primit niciun rezultat de la scriptul Python."));
+    const QString modelPath = ui->backendComboBox->currentIndex() == OnnxInt8Backend ? kOnnxInt8Model : kOnnxModel;
+    webcam->start(0, modelPath);
+    statusBar()->showMessage(tr("Camera pornită."));
+}
+
+void MainWindow::showWebcamFrame()
+{
+    const QImage frame = webcam->latestFrame();
+    if (frame.isNull() || !ui->webcamButton->isChecked()) return;
+    ui->imageLabel->setPixmap(QPixmap::fromImage(frame).scaled(480, 360, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+}
+
+void MainWindow::showWebcamPrediction(const QVector<double> &smoothed, double inferenceMs, int stride)
+{
+    if (!ui->webcamButton->isChecked()) return;
+    ui->resultLabel->setText(probabilityText(smoothed));
+    statusBar()->showMessage(tr("Cameră: inferență %1 ms, un cadru din %2").arg(inferenceMs, 0, 'f', 1).arg(stride));
+}
+
+void MainWindow::webcamFailed(const QString &message)
+{
+    if (!ui->webcamButton->isChecked()) return;
+    ui->webcamButton->setChecked(false);
+    QMessageBox::critical(this, tr("Eroare"), message);
+}
+
+void MainWindow::updateCacheLabel()
+{
+    const ResultCache::Stats stats = cache.stats();
+    const int lookups = stats.hits + stats.misses;
+    cacheLabel->setText(tr("Cache: %1% potriviri (%2/%3), %4 s economisite")
+                            .arg(lookups > 0 ? stats.hits * 100.0 / lookups : 0.0, 0, 'f', 0)
+                            .arg(stats.hits)
+                            .arg(lookups)
+                            .arg(stats.savedMs / 1000.0, 0, 'f', 1));
+}
+
+QString MainWindow::probabilityText(const QVector<double> &probabilities)
+{
+    QStringList lines;
+    int best = 0;
+    for (int i = 0; i < probabilities.size(); ++i) {
+        lines << QString("%1: %2%").arg(kClasses[i]).arg(probabilities[i] * 100, 0, 'f', 2);
+        if (probabilities[i] > probabilities[best]) best = i;
+    }
+    lines << ""
+          << QString("Predominant state: %1 (%2%)").arg(kClasses[best]).arg(probabilities[best] * 100, 0, 'f', 2);
+    return lines.join('\n');
+}
+
+void MainWindow::showProbabilities(const QVector<double> &probabilities, double latencyMs, bool fromCache)
+{
+    if (probabilities.size() != kClasses.size()) {
+        QMessageBox::critical(this, tr("Eroare"), tr("Modelul a întors %1 valori în loc de %2.")
+                                                      .arg(probabilities.size()).arg(kClasses.size()));
         return;
     }
 
-    ui->resultLabel->setText(output.trimmed());
+    ui->resultLabel->setText(probabilityText(probabilities));
+
+    statusBar()->showMessage(fromCache ? tr("Rezultat din cache în %1 ms.").arg(latencyMs, 0, 'f', 1)
+                                       : tr("Latență: %1 ms (inclusiv așteptarea în coadă)").arg(latencyMs, 0, 'f', 1));
 }
@@ -1,8 +1,20 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QFutureWatcher>
+#include <QHash>
 #include <QMainWindow>
+#include <QPair>
 #include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include "resultcache.h"
+
+class ClassificationQueue;
+class PredictionWorker;
+class QLabel;
+class WebcamClassifier;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -19,10 +31,37 @@ public:
 private slots:
     void loadImage();
     void classifyImage();
+    void cancelSelectedJobs();
+    void showJobProgress(int id, int stage);
+    void showJobResult(int id, const QVector<double> &probabilities, double latencyMs, bool fromCache);
+    void showJobError(int id, const QString &message);
+    void showJobCancelled(int id);
+    void backendChanged(int index);
+    void classifyFolder();
+    void folderClassified();
+    void toggleWebcam(bool on);
+    void showWebcamFrame();
+    void showWebcamPrediction(const QVector<double> &smoothed, double inferenceMs, int stride);
+    void webcamFailed(const QString &message);
 
 private:
+    enum Backend { OnnxBackend, OnnxInt8Backend, PythonBackend };
+
+    static QString probabilityText(const QVector<double> &probabilities);
+    void showProbabilities(const QVector<double> &probabilities, double latencyMs, bool fromCache);
+    void setJobState(int id, int percent, const QString &state, const QString &result = QString());
+    void updateCacheLabel();
+
     Ui::MainWindow *ui;
-    QString imagePath;
+    QStringList imagePaths;
+    PredictionWorker *worker;
+    ResultCache cache;
+    ClassificationQueue *queue;
+    QHash<int, int> jobRows;   // id lucrare -> rand in jobsTable
+    WebcamClassifier *webcam;
+    QLabel *cacheLabel;
+    QFutureWatcher<QPair<bool, QString>> folderWatcher;   // lotul pornit din classifyFolder()
+    std::atomic<bool> folderCancel;
 };
 
 #endif
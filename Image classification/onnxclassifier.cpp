@@ -0,0 +1,68 @@
+#include "onnxclassifier.h"
+#include <QFile>
+
+static const int kInputSize = 150;
+
+bool OnnxClassifier::load(const QString &modelPath, QString *error)
+{
+    if (!QFile::exists(modelPath)) {
+        if (error) *error = QObject::tr("Modelul ONNX nu a fost găsit la calea: ") + modelPath;
+        return false;
+    }
+
+    try {
+        net = cv::dnn::readNetFromONNX(modelPath.toStdString());
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    } catch (const cv::Exception &e) {
+        net = cv::dnn::Net();
+        if (error) *error = QString::fromStdString(e.what());
+        return false;
+    }
+    return !net.empty();
+}
+
+cv::Mat OnnxClassifier::readImage(const QString &path)
+{
+    return cv::imread(path.toStdString(), cv::IMREAD_COLOR | cv::IMREAD_IGNORE_ORIENTATION);
+}
+
+// INTER_NEAREST_EXACT ia pixelul din centru, ca PIL.Image.NEAREST folosit de load_img.
+cv::Mat OnnxClassifier::prepare(const cv::Mat &bgr)
+{
+    cv::Mat resized;
+    cv::resize(bgr, resized, cv::Size(kInputSize, kInputSize), 0, 0, cv::INTER_NEAREST_EXACT);
+    return resized;
+}
+
+QVector<double> OnnxClassifier::classify(const QString &imagePath)
+{
+    const cv::Mat image = readImage(imagePath);
+    if (image.empty()) return QVector<double>();
+    return classify(image);
+}
+
+QVector<double> OnnxClassifier::classify(const cv::Mat &bgr)
+{
+    return classifyPrepared(std::vector<cv::Mat>{prepare(bgr)}).value(0);
+}
+
+QVector<QVector<double>> OnnxClassifier::classifyPrepared(const std::vector<cv::Mat> &prepared)
+{
+    QVector<QVector<double>> rows;
+    if (prepared.empty()) return rows;
+
+    const cv::Mat blob = cv::dnn::blobFromImages(prepared, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false, CV_32F);
+    net.setInput(blob);
+    const cv::Mat output = net.forward().reshape(1, int(prepared.size()));
+
+    for (int r = 0; r < output.rows; ++r) {
+        QVector<double> probabilities;
+        const float *row = output.ptr<float>(r);
+        for (int c = 0; c < output.cols; ++c) {
+            probabilities.append(row[c]);
+        }
+        rows.append(probabilities);
+    }
+    return rows;
+}
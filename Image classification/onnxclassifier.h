@@ -0,0 +1,32 @@
+#ifndef ONNXCLASSIFIER_H
+#define ONNXCLASSIFIER_H
+
+#include <QString>
+#include <QVector>
+#include <opencv2/dnn.hpp>
+#include <opencv2/opencv.hpp>
+
+// Modelul exportat cu export_onnx.py, rulat in proces cu cv::dnn, fara Python.
+// Pregatirea imaginii urmeaza predict.py: load_img fara orientare EXIF, redimensionare
+// 150x150 cu cel mai apropiat vecin (ca PIL), RGB, impartire la 255.
+class OnnxClassifier
+{
+public:
+    bool load(const QString &modelPath, QString *error);
+    bool isLoaded() const { return !net.empty(); }
+
+    static cv::Mat readImage(const QString &path);
+    static cv::Mat prepare(const cv::Mat &bgr);
+
+    // Probabilitatile Angry, Happy, Relaxed, Sad; gol daca imaginea nu poate fi citita.
+    QVector<double> classify(const QString &imagePath);
+    QVector<double> classify(const cv::Mat &bgr);
+
+    // Imagini deja trecute prin prepare(), intr-un singur forward; un rand pe imagine.
+    QVector<QVector<double>> classifyPrepared(const std::vector<cv::Mat> &prepared);
+
+private:
+    cv::dnn::Net net;
+};
+
+#endif
@@ -1,5 +1,8 @@
 import os
 import sys
+import json
+import struct
+import time
 import warnings
 warnings.filterwarnings('ignore')
 os.environ['ENABLE_ONEDNN_OPTS'] = '0'
@@ -9,19 +12,72 @@ from tensorflow.keras.models import load_model
 from tensorflow.keras.preprocessing import image
 import numpy as np
 
-model = load_model("C:/openCV/project/T01/dog_emotion_model.h5", compile=False)
-img = image.load_img(sys.argv[1], target_size=(150, 150))
-img_array = image.img_to_array(img) / 255.0
-img_array = np.expand_dims(img_array, axis=0)
-
-predictions = model.predict(img_array, verbose=0)[0]
-result_lines = [
-    f"Angry: {predictions[0]*100:.2f}%",
-    f"Happy: {predictions[1]*100:.2f}%",
-    f"Relaxed: {predictions[2]*100:.2f}%",
-    f"Sad: {predictions[3]*100:.2f}%",
-    "",
-    f"Predominant state: {['Angry', 'Happy', 'Relaxed', 'Sad'][np.argmax(predictions)]} ({np.max(predictions)*100:.2f}%)"
-]
-
-print('\n'.join(result_lines))
+MODEL_PATH = "C:/openCV/project/T01/dog_emotion_model.h5"
+CLASSES = ['Angry', 'Happy', 'Relaxed', 'Sad']
+
+
+def load_array(path):
+    img = image.load_img(path, target_size=(150, 150))
+    img_array = image.img_to_array(img) / 255.0
+    return np.expand_dims(img_array, axis=0)
+
+
+# Cadre: 4 octeti big-endian cu lungimea, apoi JSON UTF-8.
+def read_frame(stream):
+    header = stream.read(4)
+    if len(header) < 4:
+        return None
+    size = struct.unpack('>I', header)[0]
+    return json.loads(stream.read(size).decode('utf-8'))
+
+
+def write_frame(stream, message):
+    data = json.dumps(message).encode('utf-8')
+    stream.write(struct.pack('>I', len(data)) + data)
+    stream.flush()
+
+
+# Modelul se incarca o singura data; cererile {"id", "path"} vin pe stdin pana la EOF.
+def serve():
+    stdin = sys.stdin.buffer
+    stdout = sys.stdout.buffer
+    sys.stdout = sys.stderr
+
+    model = load_model(MODEL_PATH, compile=False)
+    write_frame(stdout, {"ready": True})
+
+    while True:
+        request = read_frame(stdin)
+        if request is None:
+            break
+        start = time.perf_counter()
+        try:
+            predictions = model.predict(load_array(request["path"]), verbose=0)[0]
+            write_frame(stdout, {
+                "id": request["id"],
+                "probabilities": [float(p) for p in predictions],
+                "ms": (time.perf_counter() - start) * 1000,
+            })
+        except Exception as e:
+            write_frame(stdout, {"id": request["id"], "error": str(e)})
+
+
+def predict_once(path):
+    model = load_model(MODEL_PATH, compile=False)
+    predictions = model.predict(load_array(path), verbose=0)[0]
+    result_lines = [
+        f"Angry: {predictions[0]*100:.2f}%",
+        f"Happy: {predictions[1]*100:.2f}%",
+        f"Relaxed: {predictions[2]*100:.2f}%",
+        f"Sad: {predictions[3]*100:.2f}%",
+        "",
+        f"Predominant state: {CLASSES[np.argmax(predictions)]} ({np.max(predictions)*100:.2f}%)"
+    ]
+    print('\n'.join(result_lines))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1 and sys.argv[1] == '--serve':
+        serve()
+    else:
+        predict_once(sys.argv[1])
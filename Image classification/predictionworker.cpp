@@ -0,0 +1,218 @@
+#include "predictionworker.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+
+static const int kMaxAttempts = 2;
+static const int kMaxRestartDelayMs = 10000;
+static const int kMaxFailedStarts = 3;
+static const int kErrorTailBytes = 2000;
+
+PredictionWorker::PredictionWorker(const QString &scriptPath, QObject *parent)
+    : QObject(parent)
+    , script(scriptPath)
+    , process(nullptr)
+    , ready(false)
+    , stopping(false)
+    , restarts(0)
+    , failedStarts(0)
+    , nextId(1)
+{
+    restartTimer.setSingleShot(true);
+    connect(&restartTimer, &QTimer::timeout, this, &PredictionWorker::start);
+}
+
+PredictionWorker::~PredictionWorker()
+{
+    stopping = true;
+    if (process) {
+        process->closeWriteChannel();
+        if (!process->waitForFinished(2000)) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+}
+
+void PredictionWorker::start()
+{
+    if (process) return;
+
+    if (!QFile::exists(script)) {
+        const QString message = tr("Scriptul Python nu a fost găsit la calea: ") + script;
+        for (const Request &request : waiting) {
+            failLater(request.id, message);
+        }
+        waiting.clear();
+        emit stateChanged(message);
+        return;
+    }
+
+    buffer.clear();
+    errorTail.clear();
+    ready = false;
+    process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardOutput, this, &PredictionWorker::readFrames);
+    connect(process, &QProcess::finished, this, &PredictionWorker::processFinished);
+    connect(process, &QProcess::errorOccurred, this, &PredictionWorker::processError);
+    connect(process, &QProcess::readyReadStandardError, this, [this]() {
+        const QByteArray output = process->readAllStandardError();
+        qDebug() << "predict.py:" << output;
+        errorTail = (errorTail + output).right(kErrorTailBytes);
+    });
+
+    emit stateChanged(tr("Se încarcă modelul..."));
+    process->start("python", QStringList() << script << "--serve");
+}
+
+int PredictionWorker::classify(const QString &imagePath)
+{
+    Request request{nextId++, imagePath, QElapsedTimer(), 0};
+    request.timer.start();
+
+    if (ready) {
+        send(request);
+    } else {
+        waiting.append(request);
+        if (!process && !restartTimer.isActive()) start();
+    }
+    return request.id;
+}
+
+void PredictionWorker::cancel(int id)
+{
+    inFlight.remove(id);
+    for (int i = 0; i < waiting.size(); ++i) {
+        if (waiting[i].id == id) {
+            waiting.removeAt(i);
+            return;
+        }
+    }
+}
+
+void PredictionWorker::send(Request &request)
+{
+    const QByteArray payload = QJsonDocument(QJsonObject{
+        {"id", request.id},
+        {"path", request.path},
+    }).toJson(QJsonDocument::Compact);
+
+    QByteArray frame(4, 0);
+    qToBigEndian<quint32>(quint32(payload.size()), frame.data());
+    frame.append(payload);
+
+    ++request.attempts;
+    inFlight.insert(request.id, request);
+    process->write(frame);
+}
+
+void PredictionWorker::readFrames()
+{
+    buffer.append(process->readAllStandardOutput());
+    while (buffer.size() >= 4) {
+        const quint32 size = qFromBigEndian<quint32>(buffer.constData());
+        if (quint32(buffer.size()) < 4 + size) break;
+        const QByteArray payload = buffer.mid(4, size);
+        buffer.remove(0, 4 + size);
+        handleFrame(payload);
+    }
+}
+
+void PredictionWorker::handleFrame(const QByteArray &payload)
+{
+    const QJsonObject message = QJsonDocument::fromJson(payload).object();
+
+    if (message.value("ready").toBool()) {
+        ready = true;
+        restarts = 0;
+        failedStarts = 0;
+        emit stateChanged(tr("Model încărcat."));
+        const QList<Request> queued = waiting;
+        waiting.clear();
+        for (Request request : queued) {
+            send(request);
+        }
+        return;
+    }
+
+    const int id = message.value("id").toInt();
+    auto it = inFlight.find(id);
+    if (it == inFlight.end()) return;
+    const double latencyMs = it->timer.nsecsElapsed() / 1e6;
+    inFlight.erase(it);
+
+    if (message.contains("error")) {
+        emit failed(id, message.value("error").toString());
+        return;
+    }
+
+    QVector<double> probabilities;
+    for (const QJsonValue &value : message.value("probabilities").toArray()) {
+        probabilities.append(value.toDouble());
+    }
+    emit resultReady(id, probabilities, latencyMs, message.value("ms").toDouble());
+}
+
+void PredictionWorker::processFinished(int exitCode, QProcess::ExitStatus status)
+{
+    qDebug() << "predict.py --serve exited:" << exitCode << status;
+    scheduleRestart();
+}
+
+void PredictionWorker::processError(QProcess::ProcessError error)
+{
+    qDebug() << "predict.py --serve error:" << error;
+    if (error == QProcess::FailedToStart) {
+        scheduleRestart();
+    }
+}
+
+// start() si scheduleRestart() pot rula chiar din classify() (QProcess raporteaza FailedToStart
+// sincron), deci erorile pleaca din bucla de evenimente, dupa ce apelantul are deja id-ul.
+void PredictionWorker::failLater(int id, const QString &message)
+{
+    QMetaObject::invokeMethod(this, [this, id, message]() { emit failed(id, message); }, Qt::QueuedConnection);
+}
+
+// Cererile trimise procesului cazut revin in coada daca mai au o incercare.
+void PredictionWorker::scheduleRestart()
+{
+    if (!process) return;
+    errorTail = (errorTail + process->readAllStandardError()).right(kErrorTailBytes);
+    const QString processError = process->errorString();
+    process->deleteLater();
+    process = nullptr;
+    if (!ready) ++failedStarts;
+    ready = false;
+    if (stopping) return;
+
+    if (failedStarts >= kMaxFailedStarts) {
+        const QString details = errorTail.isEmpty() ? processError : QString::fromLocal8Bit(errorTail).trimmed();
+        const QString message = tr("Procesul Python nu a pornit de %1 ori la rând:\n%2")
+                                    .arg(failedStarts)
+                                    .arg(details);
+        for (const Request &request : waiting) {
+            failLater(request.id, message);
+        }
+        waiting.clear();
+        emit stateChanged(message);
+        return;
+    }
+
+    for (const Request &request : inFlight) {
+        if (request.attempts < kMaxAttempts) {
+            waiting.append(request);
+        } else {
+            failLater(request.id, tr("Procesul Python s-a oprit în timpul clasificării."));
+        }
+    }
+    inFlight.clear();
+
+    const int delay = qMin(500 << qMin(restarts, 5), kMaxRestartDelayMs);
+    ++restarts;
+    emit stateChanged(tr("Procesul Python s-a oprit; repornire în %1 ms.").arg(delay));
+    restartTimer.start(delay);
+}
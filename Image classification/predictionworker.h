@@ -0,0 +1,74 @@
+#ifndef PREDICTIONWORKER_H
+#define PREDICTIONWORKER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// Un singur proces "python predict.py --serve" care incarca modelul o data si raspunde la
+// cereri incadrate (lungime pe 4 octeti + JSON) pe stdin/stdout. Cererile facute cat timp
+// procesul porneste asteapta in coada. Daca procesul cade, este repornit automat (cu pauze
+// tot mai lungi), iar cererile neterminate sunt retrimise o data. Dupa 3 porniri la rand fara
+// "ready", cererile din coada esueaza cu ultimele randuri din stderr, iar urmatoarea pornire
+// se face abia la urmatorul classify().
+class PredictionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PredictionWorker(const QString &scriptPath, QObject *parent = nullptr);
+    ~PredictionWorker();
+
+    void start();
+    bool isReady() const { return ready; }
+
+    // Intoarce id-ul cererii, folosit apoi in resultReady/failed.
+    int classify(const QString &imagePath);
+    // Cererea nu mai este trimisa daca inca asteapta; daca e deja la Python, raspunsul se ignora.
+    void cancel(int id);
+
+signals:
+    // latencyMs: de la classify() pana la raspuns; inferenceMs: timpul masurat in Python.
+    void resultReady(int id, const QVector<double> &probabilities, double latencyMs, double inferenceMs);
+    void failed(int id, const QString &message);
+    void stateChanged(const QString &message);
+
+private slots:
+    void readFrames();
+    void processFinished(int exitCode, QProcess::ExitStatus status);
+    void processError(QProcess::ProcessError error);
+
+private:
+    struct Request {
+        int id;
+        QString path;
+        QElapsedTimer timer;
+        int attempts;
+    };
+
+    void send(Request &request);
+    void handleFrame(const QByteArray &payload);
+    void scheduleRestart();
+    void failLater(int id, const QString &message);
+
+    QString script;
+    QProcess *process;
+    QTimer restartTimer;
+    QByteArray buffer;
+    QByteArray errorTail;
+    bool ready;
+    bool stopping;
+    int restarts;
+    int failedStarts;
+    int nextId;
+    QMap<int, Request> inFlight;
+    QList<Request> waiting;
+};
+
+#endif
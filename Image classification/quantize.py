@@ -0,0 +1,59 @@
+import os
+import sys
+import random
+import warnings
+warnings.filterwarnings('ignore')
+
+import numpy as np
+import onnx
+from PIL import Image
+from onnxruntime.quantization import CalibrationDataReader, QuantFormat, QuantType, quantize_static
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+# Cuantizare INT8 statica (post-antrenare) a modelului ONNX exportat cu export_onnx.py.
+# Scalele activarilor se calibreaza pe un esantion din folderul de antrenare, pregatit la fel
+# ca in predict.py. Formatul QOperator (QLinearConv, QLinearMatMul) este cel citit de cv::dnn.
+train_dir = sys.argv[1] if len(sys.argv) > 1 else "C:/openCV/project/T01/Dog Emotion/train"
+fp32_path = sys.argv[2] if len(sys.argv) > 2 else "C:/openCV/project/T01/dog_emotion_model.onnx"
+int8_path = sys.argv[3] if len(sys.argv) > 3 else os.path.splitext(fp32_path)[0] + "_int8.onnx"
+samples_per_class = int(sys.argv[4]) if len(sys.argv) > 4 else 50
+
+
+def load_array(path):
+    img = Image.open(path).convert('RGB').resize((150, 150), Image.NEAREST)
+    img_array = np.asarray(img, dtype=np.float32) / 255.0
+    return np.expand_dims(img_array.transpose(2, 0, 1), axis=0)
+
+
+class TrainSample(CalibrationDataReader):
+    def __init__(self, input_name):
+        random.seed(42)
+        paths = []
+        for class_name in sorted(os.listdir(train_dir)):
+            class_dir = os.path.join(train_dir, class_name)
+            if not os.path.isdir(class_dir):
+                continue
+            images = [os.path.join(class_dir, f) for f in sorted(os.listdir(class_dir))
+                      if f.lower().endswith(('.png', '.jpg', '.jpeg', '.bmp'))]
+            paths += random.sample(images, min(samples_per_class, len(images)))
+        print(f"Calibrating on {len(paths)} images from {train_dir}")
+        self.input_name = input_name
+        self.paths = iter(paths)
+
+    def get_next(self):
+        path = next(self.paths, None)
+        return None if path is None else {self.input_name: load_array(path)}
+
+
+prepared_path = os.path.splitext(int8_path)[0] + "_prep.onnx"
+quant_pre_process(fp32_path, prepared_path)
+
+input_name = onnx.load(prepared_path).graph.input[0].name
+
+quantize_static(prepared_path, int8_path, TrainSample(input_name),
+                quant_format=QuantFormat.QOperator,
+                activation_type=QuantType.QUInt8, weight_type=QuantType.QInt8,
+                per_channel=True)
+os.remove(prepared_path)
+
+print(f"{fp32_path}: {os.path.getsize(fp32_path) / 1e6:.1f} MB -> {int8_path}: {os.path.getsize(int8_path) / 1e6:.1f} MB")
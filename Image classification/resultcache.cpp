@@ -0,0 +1,208 @@
+#include "resultcache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+static const quint32 kMagic = 0x44454331;   // "DEC1"
+static const int kSaveEvery = 64;
+
+static QByteArray hashFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
+ResultCache::ResultCache(const QString &filePath, int maxEntries)
+    : path(filePath)
+    , maxEntries(qMax(1, maxEntries))
+    , clock(0)
+    , unsaved(0)
+{
+    load();
+}
+
+ResultCache::~ResultCache()
+{
+    save();
+}
+
+QString ResultCache::defaultPath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("predictions.cache");
+}
+
+QByteArray ResultCache::imageHash(const QString &imagePath)
+{
+    return hashFile(imagePath);
+}
+
+QByteArray ResultCache::modelVersion(const QString &modelPath)
+{
+    const QFileInfo info(modelPath);
+    if (!info.exists()) return QByteArray();
+
+    const QString key = info.absoluteFilePath();
+    QMutexLocker lock(&mutex);
+    const ModelFile known = models.value(key);
+    if (!known.version.isEmpty() && known.size == info.size() && known.modified == info.lastModified()) {
+        return known.version;
+    }
+
+    lock.unlock();
+    const QByteArray version = hashFile(modelPath);
+    lock.relock();
+
+    // Modelul a fost reantrenat sau inlocuit: rezultatele vechii versiuni nu mai sunt valabile.
+    ModelFile &model = models[key];
+    const QByteArray previous = model.version;
+    if (!previous.isEmpty() && previous != version) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it.key().endsWith(previous) ? entries.erase(it) : std::next(it);
+        }
+    }
+    model.size = info.size();
+    model.modified = info.lastModified();
+    model.version = version;
+    ++unsaved;
+    return version;
+}
+
+bool ResultCache::lookup(const QByteArray &imageHash, const QByteArray &modelVersion, QVector<double> *probabilities)
+{
+    QMutexLocker lock(&mutex);
+    auto it = entries.find(imageHash + modelVersion);
+    if (imageHash.isEmpty() || modelVersion.isEmpty() || it == entries.end()) {
+        ++counters.misses;
+        return false;
+    }
+
+    it->lastUsed = ++clock;
+    ++counters.hits;
+    counters.savedMs += it->latencyMs;
+    if (probabilities) *probabilities = it->probabilities;
+    return true;
+}
+
+void ResultCache::insert(const QByteArray &imageHash, const QByteArray &modelVersion,
+                         const QVector<double> &probabilities, double latencyMs)
+{
+    if (imageHash.isEmpty() || modelVersion.isEmpty() || probabilities.isEmpty()) return;
+
+    QMutexLocker lock(&mutex);
+    entries.insert(imageHash + modelVersion, Entry{probabilities, latencyMs, ++clock});
+    evict();
+    if (++unsaved >= kSaveEvery) {
+        lock.unlock();
+        save();
+    }
+}
+
+// Se elimina o zecime odata, ca sortarea dupa ultima folosire sa nu ruleze la fiecare insert.
+void ResultCache::evict()
+{
+    if (entries.size() <= maxEntries) return;
+
+    QVector<quint64> stamps;
+    stamps.reserve(entries.size());
+    for (const Entry &entry : std::as_const(entries)) {
+        stamps.append(entry.lastUsed);
+    }
+    const int drop = entries.size() - maxEntries + maxEntries / 10;
+    std::nth_element(stamps.begin(), stamps.begin() + (drop - 1), stamps.end());
+    const quint64 cutoff = stamps[drop - 1];
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        it = it->lastUsed <= cutoff ? entries.erase(it) : std::next(it);
+    }
+}
+
+void ResultCache::load()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    in >> magic;
+    if (magic != kMagic) return;
+
+    qint32 modelCount = 0;
+    in >> modelCount;
+    for (int i = 0; i < modelCount && in.status() == QDataStream::Ok; ++i) {
+        QString modelPath;
+        ModelFile model;
+        in >> modelPath >> model.size >> model.modified >> model.version;
+        models.insert(modelPath, model);
+    }
+
+    qint32 entryCount = 0;
+    in >> entryCount;
+    for (int i = 0; i < entryCount && in.status() == QDataStream::Ok; ++i) {
+        QByteArray key;
+        Entry entry;
+        in >> key >> entry.probabilities >> entry.latencyMs >> entry.lastUsed;
+        entries.insert(key, entry);
+        clock = qMax(clock, entry.lastUsed);
+    }
+
+    // Un fisier trunchiat sau corupt inseamna doar un cache gol.
+    if (in.status() != QDataStream::Ok) {
+        models.clear();
+        entries.clear();
+        clock = 0;
+    }
+}
+
+bool ResultCache::save()
+{
+    QMutexLocker lock(&mutex);
+    if (unsaved == 0) return true;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kMagic << qint32(models.size());
+    for (auto it = models.cbegin(); it != models.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->version;
+    }
+    out << qint32(entries.size());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        out << it.key() << it->probabilities << it->latencyMs << it->lastUsed;
+    }
+
+    if (!file.commit()) return false;
+    unsaved = 0;
+    return true;
+}
+
+void ResultCache::clear()
+{
+    QMutexLocker lock(&mutex);
+    entries.clear();
+    counters = Stats();
+    ++unsaved;
+}
+
+int ResultCache::size() const
+{
+    QMutexLocker lock(&mutex);
+    return entries.size();
+}
+
+ResultCache::Stats ResultCache::stats() const
+{
+    QMutexLocker lock(&mutex);
+    return counters;
+}
@@ -0,0 +1,69 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// Probabilitatile deja calculate, pastrate pe disc intre rulari. Cheia este hash-ul SHA-1 al
+// continutului imaginii (nu calea) plus versiunea modelului, adica hash-ul fisierului de model;
+// daca modelul se schimba, intrarile vechi nu se mai potrivesc si sunt sterse. Numarul de
+// intrari este limitat, iar la depasire pleaca cele folosite cel mai demult (LRU).
+// Poate fi folosit din mai multe fire.
+class ResultCache
+{
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        double savedMs = 0;   // suma latentelor originale ale rezultatelor servite din cache
+    };
+
+    explicit ResultCache(const QString &filePath = defaultPath(), int maxEntries = 20000);
+    ~ResultCache();
+
+    static QString defaultPath();
+    static QByteArray imageHash(const QString &imagePath);
+
+    // Hash-ul modelului, recalculat doar daca marimea sau data fisierului s-au schimbat.
+    // Gol daca fisierul lipseste.
+    QByteArray modelVersion(const QString &modelPath);
+
+    bool lookup(const QByteArray &imageHash, const QByteArray &modelVersion, QVector<double> *probabilities);
+    void insert(const QByteArray &imageHash, const QByteArray &modelVersion,
+                const QVector<double> &probabilities, double latencyMs);
+
+    bool save();
+    void clear();
+    int size() const;
+    Stats stats() const;
+
+private:
+    struct Entry {
+        QVector<double> probabilities;
+        double latencyMs;
+        quint64 lastUsed;
+    };
+    struct ModelFile {
+        qint64 size = 0;
+        QDateTime modified;
+        QByteArray version;
+    };
+
+    void load();
+    void evict();
+
+    mutable QMutex mutex;
+    QString path;
+    int maxEntries;
+    QHash<QByteArray, Entry> entries;
+    QHash<QString, ModelFile> models;
+    quint64 clock;
+    int unsaved;
+    Stats counters;
+};
+
+#endif
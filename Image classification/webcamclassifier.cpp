@@ -0,0 +1,192 @@
+#include "webcamclassifier.h"
+#include "onnxclassifier.h"
+#include <QElapsedTimer>
+#include <QPainter>
+#include <cmath>
+
+static const char *kClasses[] = {"Angry", "Happy", "Relaxed", "Sad"};
+static const double kTimingAlpha = 0.1;   // media timpilor de cadru si de inferenta
+static const double kHeadroom = 1.2;      // inferenta primeste cu 20% mai mult timp decat are nevoie
+static const int kMaxStride = 60;
+
+WebcamClassifier::WebcamClassifier(QObject *parent)
+    : QObject(parent)
+    , stopping(false)
+    , framePending(false)
+    , alpha(0.3)
+    , inferring(false)
+    , frameMs(0)
+    , inferenceMs(0)
+    , stride(1)
+    , frameNumber(0)
+{
+    threads.setMaxThreadCount(2);
+}
+
+WebcamClassifier::~WebcamClassifier()
+{
+    blockSignals(true);
+    stop();
+}
+
+void WebcamClassifier::start(int cameraIndex, const QString &modelPath, double smoothing)
+{
+    stop();
+
+    alpha = qBound(0.01, smoothing, 1.0);
+    stopping = false;
+    framePending = false;
+    pending.release();
+    inferring = false;
+    frame = QImage();
+    smoothed.clear();
+    frameMs = inferenceMs = 0;
+    stride = 1;
+    frameNumber = 0;
+
+    threads.start([this, modelPath]() { inferenceLoop(modelPath); });
+    threads.start([this, cameraIndex]() { captureLoop(cameraIndex); });
+}
+
+void WebcamClassifier::stop()
+{
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        frameWanted.wakeAll();
+    }
+    threads.waitForDone();
+}
+
+QImage WebcamClassifier::latestFrame()
+{
+    QMutexLocker lock(&mutex);
+    framePending = false;
+    return frame;
+}
+
+// Citirea nu asteapta niciodata inferenta: cadrul ales este copiat si predat doar daca firul
+// de inferenta e liber, altfel se trece peste el.
+void WebcamClassifier::captureLoop(int cameraIndex)
+{
+    cv::VideoCapture capture(cameraIndex);
+    if (!capture.isOpened()) {
+        emit failed(tr("Camera %1 nu poate fi deschisă.").arg(cameraIndex));
+        return;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    cv::Mat bgr;
+    while (!stopping) {
+        if (!capture.read(bgr) || bgr.empty()) {
+            emit failed(tr("Camera nu mai trimite cadre."));
+            break;
+        }
+
+        const double interval = clock.nsecsElapsed() / 1e6;
+        clock.start();
+        QImage image = QImage(bgr.data, bgr.cols, bgr.rows, int(bgr.step), QImage::Format_BGR888)
+                           .convertToFormat(QImage::Format_RGB32);
+
+        QMutexLocker lock(&mutex);
+        frameMs = frameMs > 0 ? frameMs + kTimingAlpha * (interval - frameMs) : interval;
+        if (++frameNumber >= stride && !inferring) {
+            frameNumber = 0;
+            pending = bgr.clone();
+            inferring = true;
+            frameWanted.wakeOne();
+        }
+        drawOverlay(image);
+        frame = image;
+        lock.unlock();
+
+        if (!framePending.exchange(true)) emit frameReady();
+    }
+}
+
+void WebcamClassifier::inferenceLoop(const QString &modelPath)
+{
+    OnnxClassifier classifier;
+    QString error;
+    if (!classifier.load(modelPath, &error)) {
+        emit failed(error);
+        return;
+    }
+
+    QElapsedTimer timer;
+    forever {
+        cv::Mat bgr;
+        {
+            QMutexLocker lock(&mutex);
+            while (pending.empty() && !stopping) {
+                frameWanted.wait(&mutex);
+            }
+            if (stopping) return;
+            bgr = pending;
+            pending.release();
+        }
+
+        timer.start();
+        QVector<double> probabilities;
+        try {
+            probabilities = classifier.classify(bgr);
+        } catch (const cv::Exception &e) {
+            emit failed(QString::fromStdString(e.what()).simplified());
+            return;
+        }
+        const double ms = timer.nsecsElapsed() / 1e6;
+
+        // Pasul N acopera timpul inferentei plus o rezerva, masurat in cadre de camera.
+        QMutexLocker lock(&mutex);
+        inferring = false;
+        inferenceMs = inferenceMs > 0 ? inferenceMs + kTimingAlpha * (ms - inferenceMs) : ms;
+        if (frameMs > 0) {
+            stride = qBound(1, int(std::ceil(inferenceMs * kHeadroom / frameMs)), kMaxStride);
+        }
+        if (smoothed.size() != probabilities.size()) {
+            smoothed = probabilities;
+        } else {
+            for (int i = 0; i < smoothed.size(); ++i) {
+                smoothed[i] += alpha * (probabilities[i] - smoothed[i]);
+            }
+        }
+        const QVector<double> current = smoothed;
+        const int currentStride = stride;
+        lock.unlock();
+
+        emit predictionUpdated(current, ms, currentStride);
+    }
+}
+
+// Apelat cu mutex-ul luat: o bara pe clasa, cea dominanta evidentiata, plus N si timpul mediu.
+void WebcamClassifier::drawOverlay(QImage &image)
+{
+    if (smoothed.size() != 4) return;
+
+    int best = 0;
+    for (int i = 1; i < smoothed.size(); ++i) {
+        if (smoothed[i] > smoothed[best]) best = i;
+    }
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QFont font = painter.font();
+    font.setPixelSize(qMax(12, image.height() / 30));
+    painter.setFont(font);
+    const int line = font.pixelSize() + 6;
+    const int barWidth = image.width() / 4;
+
+    painter.fillRect(QRect(8, 8, barWidth + 130, line * 5 + 8), QColor(0, 0, 0, 150));
+    for (int i = 0; i < smoothed.size(); ++i) {
+        const int y = 12 + i * line;
+        painter.fillRect(QRect(110, y, int(barWidth * smoothed[i]), line - 6),
+                         i == best ? QColor(80, 200, 120) : QColor(160, 160, 160));
+        painter.setPen(i == best ? Qt::white : QColor(200, 200, 200));
+        painter.drawText(QRect(14, y - 2, 94, line), Qt::AlignVCenter,
+                         QString("%1 %2%").arg(kClasses[i]).arg(smoothed[i] * 100, 0, 'f', 0));
+    }
+    painter.setPen(QColor(200, 200, 200));
+    painter.drawText(QRect(14, 12 + 4 * line, barWidth + 120, line), Qt::AlignVCenter,
+                     tr("la fiecare %1 cadre, inferență %2 ms").arg(stride).arg(inferenceMs, 0, 'f', 0));
+}
@@ -0,0 +1,64 @@
+#ifndef WEBCAMCLASSIFIER_H
+#define WEBCAMCLASSIFIER_H
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+
+// Clasificare live de pe camera. Un fir citeste cadre continuu si le trimite ferestrei; doar
+// fiecare al N-lea cadru este predat firului de inferenta (ONNX), si numai daca acesta e liber,
+// asa ca citirea nu asteapta niciodata reteaua. N se recalculeaza dupa fiecare inferenta din
+// timpul mediu al inferentei si intervalul mediu dintre cadre, ca inferenta sa nu ramana in urma.
+// Probabilitatile sunt netezite cu o medie exponentiala, iar rezultatul este desenat peste cadru.
+class WebcamClassifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WebcamClassifier(QObject *parent = nullptr);
+    ~WebcamClassifier();
+
+    // smoothing: ponderea celei mai noi predictii in media exponentiala (0..1].
+    void start(int cameraIndex, const QString &modelPath, double smoothing = 0.3);
+    void stop();
+    bool isRunning() const { return threads.activeThreadCount() > 0; }
+
+    // Ultimul cadru, cu rezultatul desenat peste el; frameReady() se emite din nou abia dupa
+    // ce fereastra l-a luat, ca sa nu se adune cadre in coada de evenimente.
+    QImage latestFrame();
+
+signals:
+    void frameReady();
+    void predictionUpdated(const QVector<double> &smoothed, double inferenceMs, int stride);
+    void failed(const QString &message);
+
+private:
+    void captureLoop(int cameraIndex);
+    void inferenceLoop(const QString &modelPath);
+    void offer(const cv::Mat &frame);
+    void drawOverlay(QImage &image);
+
+    QThreadPool threads;
+    std::atomic<bool> stopping;
+    std::atomic<bool> framePending;
+    double alpha;
+
+    QMutex mutex;
+    QWaitCondition frameWanted;
+    cv::Mat pending;
+    bool inferring;
+    QImage frame;
+    QVector<double> smoothed;
+    double frameMs;       // media intervalului dintre cadre
+    double inferenceMs;   // media duratei unei inferente
+    int stride;
+    int frameNumber;
+};
+
+#endif
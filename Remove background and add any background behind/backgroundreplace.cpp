@@ -0,0 +1,18 @@
+#include "backgroundreplace.h"
+
+void replaceBackground(const cv::Mat& image, const cv::Mat& background,
+                       const cv::Scalar& backgroundColor, int thresholdValue,
+                       cv::Mat& result)
+{
+    cv::Mat grayImage, mask;
+    cv::cvtColor(image, grayImage, cv::COLOR_BGR2GRAY);
+    cv::threshold(grayImage, mask, thresholdValue, 255, cv::THRESH_BINARY_INV);
+
+    if (!background.empty()) {
+        background.copyTo(result);
+    } else {
+        result.create(image.size(), CV_8UC3);
+        result.setTo(backgroundColor);
+    }
+    image.copyTo(result, mask);
+}
@@ -0,0 +1,12 @@
+#ifndef BACKGROUNDREPLACE_H
+#define BACKGROUNDREPLACE_H
+
+#include <opencv2/opencv.hpp>
+
+// Pastreaza pixelii mai intunecati decat pragul si pune fundalul in rest.
+// background trebuie sa aiba deja dimensiunea lui image; daca e gol se foloseste culoarea.
+void replaceBackground(const cv::Mat& image, const cv::Mat& background,
+                       const cv::Scalar& backgroundColor, int thresholdValue,
+                       cv::Mat& result);
+
+#endif
@@ -0,0 +1,222 @@
+#include "batchprocessor.h"
+#include "backgroundreplace.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+
+static const size_t kMaxResizedBackgrounds = 4;
+
+BatchProcessor::BatchProcessor(const BatchSettings& settings)
+    : settings(settings)
+    , processed(0)
+    , pixels(0)
+    , backgroundResizes(0)
+    , elapsed(0)
+{
+}
+
+bool BatchProcessor::run()
+{
+    if (!QDir(settings.inputDir).exists()) {
+        error = "Folderul de intrare nu exista: " + settings.inputDir;
+        return false;
+    }
+    if (!QDir().mkpath(settings.outputDir)) {
+        error = "Nu s-a putut crea folderul de iesire: " + settings.outputDir;
+        return false;
+    }
+
+    if (!settings.backgroundPath.isEmpty()) {
+        backgroundSource = cv::imread(settings.backgroundPath.toStdString());
+        if (backgroundSource.empty()) {
+            error = "Nu s-a putut incarca imaginea de fundal: " + settings.backgroundPath;
+            return false;
+        }
+    }
+
+    QDirIterator it(settings.inputDir, QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp",
+                    QDir::Files, settings.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+    files.sort();
+    assignTargets();
+
+    QThreadPool pool;
+    if (settings.threads > 0) {
+        pool.setMaxThreadCount(settings.threads);
+    }
+    settings.threads = pool.maxThreadCount();
+
+    // Paralelismul e intre imagini; firele interne OpenCV ar concura pentru aceleasi nuclee.
+    int openCvThreads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    QElapsedTimer timer;
+    timer.start();
+    QtConcurrent::blockingMap(&pool, files, [this](const QString& path) { processFile(path); });
+    elapsed = timer.elapsed();
+
+    cv::setNumThreads(openCvThreads);
+    return true;
+}
+
+// a.png si a.jpg din acelasi folder ar da acelasi a.<format>, scris din doua fire deodata;
+// in acest caz numele pastreaza si extensia sursei (a.png.png, a.jpg.png).
+void BatchProcessor::assignTargets()
+{
+    auto nameFor = [this](const QString& path, bool keepSuffix) {
+        QFileInfo relative(QDir(settings.inputDir).relativeFilePath(path));
+        QString base = keepSuffix ? relative.fileName() : relative.completeBaseName();
+        return QDir::cleanPath(QDir(settings.outputDir).filePath(
+            relative.path() + "/" + base + "." + settings.outputFormat));
+    };
+
+    QHash<QString, int> uses;
+    for (const QString& path : files) {
+        ++uses[nameFor(path, false).toLower()];
+    }
+    targets.clear();
+    for (const QString& path : files) {
+        targets.insert(path, nameFor(path, uses.value(nameFor(path, false).toLower()) > 1));
+    }
+}
+
+void BatchProcessor::processFile(const QString& path)
+{
+    try {
+        cv::Mat image = cv::imread(path.toStdString());
+        if (image.empty()) {
+            addFailure(path, "imaginea nu a putut fi decodata");
+            return;
+        }
+
+        cv::Mat background;
+        if (!backgroundSource.empty()) {
+            background = backgroundForSize(image.size());
+        }
+
+        cv::Mat result;
+        replaceBackground(image, background, settings.backgroundColor, settings.thresholdValue, result);
+
+        const QString target = targets.value(path);
+        QDir().mkpath(QFileInfo(target).path());
+
+        if (!cv::imwrite(target.toStdString(), result)) {
+            addFailure(path, "nu s-a putut scrie " + target);
+            return;
+        }
+
+        pixels += static_cast<qint64>(image.total());
+        ++processed;
+    } catch (const cv::Exception& e) {
+        addFailure(path, QString::fromStdString(e.what()));
+    } catch (const std::exception& e) {
+        addFailure(path, QString::fromLocal8Bit(e.what()));
+    }
+}
+
+cv::Mat BatchProcessor::backgroundForSize(const cv::Size& size)
+{
+    std::pair<int, int> key(size.width, size.height);
+    std::promise<cv::Mat> promise;
+    std::shared_future<cv::Mat> future;
+    bool owner = false;
+
+    {
+        QMutexLocker locker(&backgroundMutex);
+        auto it = resizedBackgrounds.find(key);
+        if (it == resizedBackgrounds.end()) {
+            future = promise.get_future().share();
+            resizedBackgrounds.emplace(key, future);
+            owner = true;
+        } else {
+            future = it->second;
+            backgroundOrder.erase(std::find(backgroundOrder.begin(), backgroundOrder.end(), key));
+        }
+        backgroundOrder.push_front(key);
+
+        // Firele care inca folosesc un fundal scos de aici au propria copie a future-ului.
+        while (backgroundOrder.size() > kMaxResizedBackgrounds) {
+            resizedBackgrounds.erase(backgroundOrder.back());
+            backgroundOrder.pop_back();
+        }
+    }
+
+    // Redimensionarea se face in afara lock-ului; celelalte fire cu aceeasi dimensiune asteapta rezultatul.
+    if (owner) {
+        try {
+            cv::Mat resized;
+            cv::resize(backgroundSource, resized, size);
+            ++backgroundResizes;
+            promise.set_value(resized);
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+    return future.get();
+}
+
+void BatchProcessor::addFailure(const QString& file, const QString& reason)
+{
+    QMutexLocker locker(&failureMutex);
+    failures.append({file, reason});
+}
+
+QList<BatchFailure> BatchProcessor::failureList() const
+{
+    QMutexLocker locker(&failureMutex);
+    return failures;
+}
+
+double BatchProcessor::imagesPerSecond() const
+{
+    return elapsed > 0 ? processed.load() * 1000.0 / elapsed : 0.0;
+}
+
+double BatchProcessor::megapixelsPerSecond() const
+{
+    return elapsed > 0 ? pixels.load() / 1000.0 / elapsed : 0.0;
+}
+
+bool BatchProcessor::writeReport(const QString& path) const
+{
+    QJsonObject report;
+    report["input"] = settings.inputDir;
+    report["output"] = settings.outputDir;
+    report["threshold"] = settings.thresholdValue;
+    if (!settings.backgroundPath.isEmpty()) {
+        report["background"] = settings.backgroundPath;
+    } else {
+        report["backgroundColor"] = QJsonArray{settings.backgroundColor[2], settings.backgroundColor[1],
+                                               settings.backgroundColor[0]};
+    }
+    report["threads"] = settings.threads;
+    report["images"] = files.size();
+    report["processed"] = processed.load();
+    report["elapsedMs"] = elapsed;
+    report["imagesPerSecond"] = imagesPerSecond();
+    report["megapixelsPerSecond"] = megapixelsPerSecond();
+    report["backgroundResizes"] = backgroundResizes.load();
+
+    QJsonArray failed;
+    for (const BatchFailure& failure : failureList()) {
+        failed.append(QJsonObject{{"file", failure.file}, {"reason", failure.reason}});
+    }
+    report["failed"] = failed.size();
+    report["failures"] = failed;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    file.write(QJsonDocument(report).toJson());
+    return true;
+}
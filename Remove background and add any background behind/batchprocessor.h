@@ -0,0 +1,75 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <future>
+#include <list>
+#include <map>
+#include <utility>
+
+struct BatchSettings {
+    QString inputDir;
+    QString outputDir;
+    QString backgroundPath;
+    QString outputFormat = "png";
+    cv::Scalar backgroundColor = cv::Scalar(255, 255, 255);
+    int thresholdValue = 128;
+    int threads = 0;
+    bool recursive = false;
+};
+
+struct BatchFailure {
+    QString file;
+    QString reason;
+};
+
+// Aplica MainWindow::updateImage pe toate imaginile dintr-un folder. Fiecare fir decodeaza,
+// prelucreaza si scrie cate o imagine; fundalul redimensionat se pastreaza pentru ultimele
+// cateva dimensiuni distincte de imagine, ca memoria sa nu creasca cu fiecare rezolutie noua.
+class BatchProcessor {
+public:
+    explicit BatchProcessor(const BatchSettings& settings);
+
+    bool run();
+    bool writeReport(const QString& path) const;
+
+    QString errorString() const { return error; }
+    int totalCount() const { return files.size(); }
+    int processedCount() const { return processed.load(); }
+    QList<BatchFailure> failureList() const;
+    qint64 elapsedMs() const { return elapsed; }
+    double imagesPerSecond() const;
+    double megapixelsPerSecond() const;
+
+private:
+    void assignTargets();
+    void processFile(const QString& path);
+    cv::Mat backgroundForSize(const cv::Size& size);
+    void addFailure(const QString& file, const QString& reason);
+
+    BatchSettings settings;
+    QString error;
+    QStringList files;
+    QHash<QString, QString> targets;   // imagine -> fisier de iesire, stabilit inainte de pornire
+    cv::Mat backgroundSource;
+
+    QMutex backgroundMutex;
+    std::map<std::pair<int, int>, std::shared_future<cv::Mat>> resizedBackgrounds;
+    std::list<std::pair<int, int>> backgroundOrder;   // cea mai recent folosita dimensiune primul
+
+    mutable QMutex failureMutex;
+    QList<BatchFailure> failures;
+
+    std::atomic<int> processed;
+    std::atomic<qint64> pixels;
+    std::atomic<int> backgroundResizes;
+    qint64 elapsed;
+};
+
+#endif
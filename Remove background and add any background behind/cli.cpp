@@ -0,0 +1,117 @@
+#include "cli.h"
+#include "batchprocessor.h"
+#include "stripprocessor.h"
+#include <QColor>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <cstring>
+
+bool isHeadlessInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stream") == 0 || std::strcmp(argv[i], "--batch") == 0) return true;
+    }
+    return false;
+}
+
+int runHeadless(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Inlocuire fundal fara interfata grafica.");
+    parser.addHelpOption();
+
+    QCommandLineOption streamOption("stream",
+        "Prelucreaza o imagine pe benzi orizontale, cu memorie limitata.");
+    QCommandLineOption batchOption("batch",
+        "Prelucreaza toate imaginile dintr-un folder, in paralel.");
+    QCommandLineOption inputOption(QStringList() << "i" << "input",
+        "Imaginea de intrare (--stream) sau folderul de intrare (--batch).", "cale");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+        "Imaginea rezultata (.png, .tif, .ppm) sau folderul de iesire.", "cale");
+    QCommandLineOption thresholdOption("threshold", "Pragul (0-255).", "valoare", "128");
+    QCommandLineOption backgroundOption("background", "Imaginea de fundal.", "fisier");
+    QCommandLineOption colorOption("color", "Culoarea de fundal (#rrggbb).", "culoare", "#ffffff");
+    QCommandLineOption memoryOption("max-memory", "Memoria maxima folosita de --stream, in MB.", "MB", "256");
+    QCommandLineOption formatOption("format", "Formatul imaginilor scrise de --batch.", "ext", "png");
+    QCommandLineOption threadsOption("threads", "Numarul de fire pentru --batch (0 = toate nucleele).", "n", "0");
+    QCommandLineOption recursiveOption("recursive", "Include si subfolderele in --batch.");
+    QCommandLineOption reportOption("report", "Raportul JSON al lui --batch.", "fisier");
+
+    parser.addOptions({streamOption, batchOption, inputOption, outputOption, thresholdOption,
+                       backgroundOption, colorOption, memoryOption, formatOption, threadsOption,
+                       recursiveOption, reportOption});
+    parser.process(arguments);
+
+    if (!parser.isSet(inputOption) || !parser.isSet(outputOption)) {
+        err << "Trebuie specificate --input si --output.\n";
+        return 1;
+    }
+
+    QColor color(parser.value(colorOption));
+    if (!color.isValid()) {
+        err << "Culoare invalida: " << parser.value(colorOption) << "\n";
+        return 1;
+    }
+    cv::Scalar backgroundColor(color.blue(), color.green(), color.red());
+    int thresholdValue = qBound(0, parser.value(thresholdOption).toInt(), 255);
+
+    if (parser.isSet(batchOption)) {
+        BatchSettings settings;
+        settings.inputDir = parser.value(inputOption);
+        settings.outputDir = parser.value(outputOption);
+        settings.backgroundPath = parser.value(backgroundOption);
+        settings.outputFormat = parser.value(formatOption).toLower();
+        settings.backgroundColor = backgroundColor;
+        settings.thresholdValue = thresholdValue;
+        settings.threads = qMax(0, parser.value(threadsOption).toInt());
+        settings.recursive = parser.isSet(recursiveOption);
+
+        BatchProcessor processor(settings);
+        if (!processor.run()) {
+            err << "Eroare: " << processor.errorString() << "\n";
+            return 2;
+        }
+
+        QString reportPath = parser.isSet(reportOption) ? parser.value(reportOption)
+                                                        : QDir(settings.outputDir).filePath("report.json");
+        if (!processor.writeReport(reportPath)) {
+            err << "Nu s-a putut scrie raportul " << reportPath << "\n";
+        }
+
+        const QList<BatchFailure> failures = processor.failureList();
+        out << processor.processedCount() << "/" << processor.totalCount() << " imagini in "
+            << processor.elapsedMs() << " ms (" << QString::number(processor.imagesPerSecond(), 'f', 1)
+            << " imagini/s, " << QString::number(processor.megapixelsPerSecond(), 'f', 1) << " MP/s), "
+            << failures.size() << " erori\n";
+        for (const BatchFailure& failure : failures) {
+            out << "  " << failure.file << ": " << failure.reason << "\n";
+        }
+        return failures.isEmpty() ? 0 : 3;
+    }
+
+    StripSettings settings;
+    settings.inputPath = parser.value(inputOption).toStdString();
+    settings.outputPath = parser.value(outputOption).toStdString();
+    settings.backgroundPath = parser.value(backgroundOption).toStdString();
+    settings.backgroundColor = backgroundColor;
+    settings.thresholdValue = thresholdValue;
+    settings.memoryBudget = static_cast<size_t>(qMax(1, parser.value(memoryOption).toInt())) * 1024u * 1024u;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    StripProcessor processor(settings);
+    if (!processor.run()) {
+        err << "Eroare: " << QString::fromStdString(processor.errorString()) << "\n";
+        return 2;
+    }
+
+    out << "Benzi de " << processor.stripRows() << " randuri, memorie estimata "
+        << processor.peakBytes() / (1024 * 1024) << " MB, " << timer.elapsed() << " ms\n";
+    return 0;
+}
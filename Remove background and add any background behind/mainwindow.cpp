@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "backgroundreplace.h"
 #include <QMessageBox>
 #include <QDebug>
 
@@ -95,21 +96,11 @@ void MainWindow::updateImage()
 {
     if (originalImage.empty()) return;
 
-    cv::Mat grayImage, mask;
-    cv::cvtColor(originalImage, grayImage, cv::COLOR_BGR2GRAY);
-    cv::threshold(grayImage, mask, thresholdValue, 255, cv::THRESH_BINARY_INV);
-
+    cv::Mat resizedBackground;
     if (useBackgroundImage && !backgroundImage.empty()) {
-        cv::Mat resizedBackground;
         cv::resize(backgroundImage, resizedBackground, originalImage.size());
-
-        resizedBackground.copyTo(result);
-        originalImage.copyTo(result, mask);
-    } else {
-        cv::Mat colorBackground(originalImage.size(), CV_8UC3, backgroundColor);
-        colorBackground.copyTo(result);
-        originalImage.copyTo(result, mask);
     }
+    replaceBackground(originalImage, resizedBackground, backgroundColor, thresholdValue, result);
 
     QImage qImage = cvMatToQImage(result);
     scene->clear();
@@ -0,0 +1,613 @@
+#include "stripio.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+
+static std::string lowerExtension(const std::string& path)
+{
+    std::string::size_type dot = path.find_last_of('.');
+    if (dot == std::string::npos) return std::string();
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+static void put16(std::vector<unsigned char>& buffer, uint32_t value)
+{
+    buffer.push_back(value & 0xFF);
+    buffer.push_back((value >> 8) & 0xFF);
+}
+
+static void put32(std::vector<unsigned char>& buffer, uint32_t value)
+{
+    put16(buffer, value & 0xFFFF);
+    put16(buffer, value >> 16);
+}
+
+static void put32BigEndian(std::vector<unsigned char>& buffer, uint32_t value)
+{
+    buffer.push_back((value >> 24) & 0xFF);
+    buffer.push_back((value >> 16) & 0xFF);
+    buffer.push_back((value >> 8) & 0xFF);
+    buffer.push_back(value & 0xFF);
+}
+
+// ---------------------------------------------------------------- citire
+
+class PnmStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        in.open(path, std::ios::binary);
+        if (!in) {
+            error = "Nu s-a putut deschide " + path;
+            return false;
+        }
+
+        char magic[2] = {0, 0};
+        in.read(magic, 2);
+        if (magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+            error = "Doar PPM/PGM binar (P5/P6) este suportat";
+            return false;
+        }
+        channels = magic[1] == '6' ? 3 : 1;
+
+        int maxValue = 0;
+        if (!readHeaderNumber(imageWidth) || !readHeaderNumber(imageHeight) || !readHeaderNumber(maxValue)
+            || imageWidth <= 0 || imageHeight <= 0) {
+            error = "Antet PNM invalid";
+            return false;
+        }
+        if (maxValue != 255) {
+            error = "Doar PNM pe 8 biti este suportat";
+            return false;
+        }
+        in.get();
+        return true;
+    }
+
+    bool read(int maxRows, cv::Mat& strip) override
+    {
+        int rows = std::min(maxRows, imageHeight - currentRow);
+        if (rows <= 0) return false;
+
+        raw.create(rows, imageWidth, channels == 3 ? CV_8UC3 : CV_8UC1);
+        in.read(reinterpret_cast<char*>(raw.data), static_cast<std::streamsize>(raw.total() * raw.elemSize()));
+        if (!in) return false;
+
+        cv::cvtColor(raw, strip, channels == 3 ? cv::COLOR_RGB2BGR : cv::COLOR_GRAY2BGR);
+        currentRow += rows;
+        return true;
+    }
+
+private:
+    bool readHeaderNumber(int& value)
+    {
+        int c = in.get();
+        while (in && (std::isspace(c) || c == '#')) {
+            if (c == '#') {
+                while (in && c != '\n') c = in.get();
+            }
+            c = in.get();
+        }
+        if (!in || !std::isdigit(c)) return false;
+
+        value = 0;
+        while (in && std::isdigit(c)) {
+            value = value * 10 + (c - '0');
+            c = in.get();
+        }
+        in.unget();
+        return true;
+    }
+
+    std::ifstream in;
+    int channels = 3;
+    cv::Mat raw;
+};
+
+class TiffStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        in.open(path, std::ios::binary);
+        if (!in) {
+            error = "Nu s-a putut deschide " + path;
+            return false;
+        }
+
+        unsigned char header[8];
+        if (!in.read(reinterpret_cast<char*>(header), 8)) {
+            error = "Antet TIFF invalid";
+            return false;
+        }
+        if (header[0] == 'I' && header[1] == 'I') {
+            bigEndian = false;
+        } else if (header[0] == 'M' && header[1] == 'M') {
+            bigEndian = true;
+        } else {
+            error = "Antet TIFF invalid";
+            return false;
+        }
+        if (get16(header + 2) != 42) {
+            error = "BigTIFF nu este suportat";
+            return false;
+        }
+
+        in.seekg(get32(header + 4));
+        unsigned char countBytes[2];
+        if (!in.read(reinterpret_cast<char*>(countBytes), 2)) {
+            error = "Director TIFF invalid";
+            return false;
+        }
+        std::vector<unsigned char> entries(get16(countBytes) * 12);
+        in.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+
+        uint32_t compression = 1, planar = 1, photometric = 2, bitsPerSample = 8;
+        std::vector<uint32_t> values;
+        for (size_t i = 0; in && i < entries.size(); i += 12) {
+            const unsigned char* entry = entries.data() + i;
+            uint16_t tag = get16(entry);
+            if (!readValues(entry, values) || values.empty()) continue;
+
+            switch (tag) {
+            case 256: imageWidth = static_cast<int>(values[0]); break;
+            case 257: imageHeight = static_cast<int>(values[0]); break;
+            case 258: bitsPerSample = values[0]; break;
+            case 259: compression = values[0]; break;
+            case 262: photometric = values[0]; break;
+            case 273: stripOffsets = values; break;
+            case 277: samples = static_cast<int>(values[0]); break;
+            case 278: rowsPerStrip = values[0]; break;
+            case 284: planar = values[0]; break;
+            case 322: error = "TIFF cu tile-uri nu este suportat"; return false;
+            }
+        }
+
+        if (!in || imageWidth <= 0 || imageHeight <= 0 || stripOffsets.empty()) {
+            error = "Director TIFF invalid";
+            return false;
+        }
+        if (compression != 1 || planar != 1 || bitsPerSample != 8 || (samples != 1 && samples != 3 && samples != 4)) {
+            error = "Doar TIFF necomprimat, 8 biti, gri/RGB/RGBA este suportat pentru streaming";
+            return false;
+        }
+        minIsWhite = photometric == 0;
+        // 0 nu este valid; ca valoarea implicita din TIFF, inseamna o singura banda pe toata imaginea.
+        if (rowsPerStrip == 0) rowsPerStrip = static_cast<uint32_t>(imageHeight);
+        rowsPerStrip = std::min<uint32_t>(rowsPerStrip, static_cast<uint32_t>(imageHeight));
+        return true;
+    }
+
+    bool read(int maxRows, cv::Mat& strip) override
+    {
+        int rows = std::min(maxRows, imageHeight - currentRow);
+        if (rows <= 0) return false;
+
+        size_t rowBytes = static_cast<size_t>(imageWidth) * samples;
+        raw.create(rows, imageWidth, CV_8UC(samples));
+
+        int row = 0;
+        while (row < rows) {
+            uint32_t absoluteRow = static_cast<uint32_t>(currentRow + row);
+            size_t stripIndex = absoluteRow / rowsPerStrip;
+            if (stripIndex >= stripOffsets.size()) return false;
+
+            uint32_t rowInStrip = absoluteRow % rowsPerStrip;
+            int count = std::min<int>(rows - row, static_cast<int>(rowsPerStrip - rowInStrip));
+
+            in.seekg(static_cast<std::streamoff>(stripOffsets[stripIndex]) + static_cast<std::streamoff>(rowInStrip * rowBytes));
+            in.read(reinterpret_cast<char*>(raw.ptr(row)), static_cast<std::streamsize>(count * rowBytes));
+            if (!in) return false;
+            row += count;
+        }
+
+        if (samples == 3) {
+            cv::cvtColor(raw, strip, cv::COLOR_RGB2BGR);
+        } else if (samples == 4) {
+            cv::cvtColor(raw, strip, cv::COLOR_RGBA2BGR);
+        } else {
+            if (minIsWhite) cv::bitwise_not(raw, raw);
+            cv::cvtColor(raw, strip, cv::COLOR_GRAY2BGR);
+        }
+        currentRow += rows;
+        return true;
+    }
+
+private:
+    uint16_t get16(const unsigned char* p) const
+    {
+        return bigEndian ? static_cast<uint16_t>((p[0] << 8) | p[1])
+                         : static_cast<uint16_t>((p[1] << 8) | p[0]);
+    }
+
+    uint32_t get32(const unsigned char* p) const
+    {
+        return bigEndian ? (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]
+                         : (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | p[0];
+    }
+
+    bool readValues(const unsigned char* entry, std::vector<uint32_t>& values)
+    {
+        uint16_t type = get16(entry + 2);
+        uint32_t count = get32(entry + 4);
+        size_t size = type == 3 ? 2 : type == 4 ? 4 : 0;
+        values.clear();
+        if (size == 0 || count == 0) return false;
+
+        std::vector<unsigned char> data(count * size);
+        if (data.size() <= 4) {
+            std::copy(entry + 8, entry + 8 + data.size(), data.begin());
+        } else {
+            std::streampos position = in.tellg();
+            in.seekg(get32(entry + 8));
+            in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            in.seekg(position);
+            if (!in) return false;
+        }
+
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(size == 2 ? get16(data.data() + i * 2) : get32(data.data() + i * 4));
+        }
+        return true;
+    }
+
+    std::ifstream in;
+    bool bigEndian = false;
+    bool minIsWhite = false;
+    int samples = 1;
+    uint32_t rowsPerStrip = 0xFFFFFFFF;
+    std::vector<uint32_t> stripOffsets;
+    cv::Mat raw;
+};
+
+class FullImageStripReader : public StripReader {
+public:
+    bool openFile(const std::string& path, std::string& error)
+    {
+        image = cv::imread(path);
+        if (image.empty()) {
+            error = "Nu s-a putut incarca " + path;
+            return false;
+        }
+        imageWidth = image.cols;
+        imageHeight = image.rows;
+        return true;
+    }
+
+    bool isStreaming() const override { return false; }
+
+    bool read(int maxRows, cv::Mat& strip) override
+    {
+        int rows = std::min(maxRows, imageHeight - currentRow);
+        if (rows <= 0) return false;
+
+        image.rowRange(currentRow, currentRow + rows).copyTo(strip);
+        currentRow += rows;
+        return true;
+    }
+
+private:
+    cv::Mat image;
+};
+
+std::unique_ptr<StripReader> StripReader::open(const std::string& path, std::string& error)
+{
+    std::string ext = lowerExtension(path);
+
+    if (ext == "ppm" || ext == "pgm" || ext == "pnm") {
+        std::unique_ptr<PnmStripReader> reader(new PnmStripReader);
+        if (reader->openFile(path, error)) return reader;
+        return nullptr;
+    }
+
+    if (ext == "tif" || ext == "tiff") {
+        std::unique_ptr<TiffStripReader> reader(new TiffStripReader);
+        if (reader->openFile(path, error)) return reader;
+        // TIFF comprimat: se decodeaza intreg, ca in aplicatie
+    }
+
+    std::unique_ptr<FullImageStripReader> reader(new FullImageStripReader);
+    if (reader->openFile(path, error)) return reader;
+    return nullptr;
+}
+
+// ---------------------------------------------------------------- scriere
+
+class PnmStripWriter : public StripWriter {
+public:
+    bool begin()
+    {
+        std::string header = "P6\n" + std::to_string(imageWidth) + " " + std::to_string(imageHeight) + "\n255\n";
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        return static_cast<bool>(out);
+    }
+
+    bool write(const cv::Mat& strip) override
+    {
+        cv::cvtColor(strip, rgb, cv::COLOR_BGR2RGB);
+        for (int y = 0; y < rgb.rows; ++y) {
+            out.write(reinterpret_cast<const char*>(rgb.ptr(y)), imageWidth * 3);
+        }
+        rowsWritten += strip.rows;
+        return static_cast<bool>(out);
+    }
+
+    bool finish() override
+    {
+        out.close();
+        return rowsWritten == imageHeight && !out.fail();
+    }
+
+private:
+    cv::Mat rgb;
+};
+
+// PNG cu blocuri deflate "stored": nu comprima, dar se poate scrie banda cu banda
+// fara zlib/libpng, iar orice cititor PNG il deschide.
+class PngStripWriter : public StripWriter {
+public:
+    bool begin()
+    {
+        static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.write(reinterpret_cast<const char*>(signature), 8);
+
+        std::vector<unsigned char> header;
+        put32BigEndian(header, static_cast<uint32_t>(imageWidth));
+        put32BigEndian(header, static_cast<uint32_t>(imageHeight));
+        header.push_back(8);   // biti pe canal
+        header.push_back(2);   // RGB
+        header.push_back(0);
+        header.push_back(0);
+        header.push_back(0);
+        writeChunk("IHDR", header);
+
+        zlibHeaderWritten = false;
+        return static_cast<bool>(out);
+    }
+
+    bool write(const cv::Mat& strip) override
+    {
+        cv::cvtColor(strip, rgb, cv::COLOR_BGR2RGB);
+
+        rowBuffer.clear();
+        if (!zlibHeaderWritten) {
+            rowBuffer.push_back(0x78);
+            rowBuffer.push_back(0x01);
+            zlibHeaderWritten = true;
+        }
+
+        size_t rowBytes = static_cast<size_t>(imageWidth) * 3 + 1;
+        size_t pending = 0;
+        for (int y = 0; y < rgb.rows; ++y) {
+            raw.resize(pending + rowBytes);
+            raw[pending] = 0;   // filtru "None"
+            std::copy(rgb.ptr(y), rgb.ptr(y) + imageWidth * 3, raw.begin() + pending + 1);
+            pending += rowBytes;
+        }
+        appendStoredBlocks(raw.data(), pending, false);
+        writeChunk("IDAT", rowBuffer);
+
+        rowsWritten += strip.rows;
+        return static_cast<bool>(out);
+    }
+
+    bool finish() override
+    {
+        rowBuffer.clear();
+        appendStoredBlocks(nullptr, 0, true);
+        put32BigEndian(rowBuffer, (adlerB << 16) | adlerA);
+        writeChunk("IDAT", rowBuffer);
+        writeChunk("IEND", std::vector<unsigned char>());
+        out.close();
+        return rowsWritten == imageHeight && !out.fail();
+    }
+
+private:
+    void appendStoredBlocks(const unsigned char* data, size_t size, bool final)
+    {
+        size_t offset = 0;
+        do {
+            size_t length = std::min<size_t>(size - offset, 65535);
+            bool last = final && offset + length == size;
+            rowBuffer.push_back(last ? 1 : 0);
+            put16(rowBuffer, static_cast<uint32_t>(length));
+            put16(rowBuffer, static_cast<uint32_t>(~length & 0xFFFF));
+            rowBuffer.insert(rowBuffer.end(), data + offset, data + offset + length);
+            offset += length;
+        } while (offset < size);
+
+        for (size_t i = 0; i < size; ++i) {
+            adlerA = (adlerA + data[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+
+    void writeChunk(const char* type, const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> length;
+        put32BigEndian(length, static_cast<uint32_t>(data.size()));
+        out.write(reinterpret_cast<const char*>(length.data()), 4);
+        out.write(type, 4);
+        if (!data.empty()) {
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        }
+
+        uint32_t crc = updateCrc(0xFFFFFFFF, reinterpret_cast<const unsigned char*>(type), 4);
+        crc = updateCrc(crc, data.data(), data.size()) ^ 0xFFFFFFFF;
+        std::vector<unsigned char> crcBytes;
+        put32BigEndian(crcBytes, crc);
+        out.write(reinterpret_cast<const char*>(crcBytes.data()), 4);
+    }
+
+    // Tabelul se construieste intr-un initializator static, sigur si cand --batch scrie din mai multe fire.
+    static uint32_t updateCrc(uint32_t crc, const unsigned char* data, size_t size)
+    {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> values;
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+            return values;
+        }();
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    cv::Mat rgb;
+    std::vector<unsigned char> raw;
+    bool zlibHeaderWritten = false;
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+};
+
+// TIFF baseline necomprimat; directorul (IFD) se scrie la final, cand se stie unde e fiecare banda.
+class TiffStripWriter : public StripWriter {
+public:
+    bool begin()
+    {
+        rowBytes = static_cast<uint32_t>(imageWidth) * 3;
+        rowsPerStrip = std::max<uint32_t>(1, 65536 / rowBytes);
+
+        std::vector<unsigned char> header = {'I', 'I'};
+        put16(header, 42);
+        put32(header, 0);   // offset-ul IFD, completat in finish()
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        return static_cast<bool>(out);
+    }
+
+    bool write(const cv::Mat& strip) override
+    {
+        cv::cvtColor(strip, rgb, cv::COLOR_BGR2RGB);
+        for (int y = 0; y < rgb.rows; ++y) {
+            out.write(reinterpret_cast<const char*>(rgb.ptr(y)), rowBytes);
+        }
+        rowsWritten += strip.rows;
+        return static_cast<bool>(out);
+    }
+
+    bool finish() override
+    {
+        const uint32_t dataStart = 8;
+        uint32_t stripCount = (static_cast<uint32_t>(imageHeight) + rowsPerStrip - 1) / rowsPerStrip;
+
+        uint32_t ifdOffset = dataStart + rowBytes * static_cast<uint32_t>(imageHeight);
+        std::vector<unsigned char> padding;
+        if (ifdOffset % 2) {
+            padding.push_back(0);
+            ++ifdOffset;
+        }
+
+        const uint16_t entryCount = 10;
+        uint32_t extraOffset = ifdOffset + 2 + entryCount * 12 + 4;
+        uint32_t bitsOffset = extraOffset;
+        uint32_t offsetsOffset = bitsOffset + 6;
+        uint32_t countsOffset = offsetsOffset + stripCount * 4;
+
+        std::vector<unsigned char> ifd = padding;
+        put16(ifd, entryCount);
+        auto entry = [&ifd](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+            put16(ifd, tag);
+            put16(ifd, type);
+            put32(ifd, count);
+            if (type == 3 && count == 1) {
+                put16(ifd, value);
+                put16(ifd, 0);
+            } else {
+                put32(ifd, value);
+            }
+        };
+
+        std::vector<uint32_t> offsets, counts;
+        for (uint32_t s = 0; s < stripCount; ++s) {
+            uint32_t rows = std::min(rowsPerStrip, static_cast<uint32_t>(imageHeight) - s * rowsPerStrip);
+            offsets.push_back(dataStart + s * rowsPerStrip * rowBytes);
+            counts.push_back(rows * rowBytes);
+        }
+
+        entry(256, 4, 1, static_cast<uint32_t>(imageWidth));
+        entry(257, 4, 1, static_cast<uint32_t>(imageHeight));
+        entry(258, 3, 3, bitsOffset);
+        entry(259, 3, 1, 1);
+        entry(262, 3, 1, 2);
+        entry(273, 4, stripCount, stripCount == 1 ? offsets[0] : offsetsOffset);
+        entry(277, 3, 1, 3);
+        entry(278, 4, 1, rowsPerStrip);
+        entry(279, 4, stripCount, stripCount == 1 ? counts[0] : countsOffset);
+        entry(284, 3, 1, 1);
+        put32(ifd, 0);
+
+        put16(ifd, 8);
+        put16(ifd, 8);
+        put16(ifd, 8);
+        for (uint32_t offset : offsets) put32(ifd, offset);
+        for (uint32_t count : counts) put32(ifd, count);
+
+        out.write(reinterpret_cast<const char*>(ifd.data()), static_cast<std::streamsize>(ifd.size()));
+
+        std::vector<unsigned char> offsetBytes;
+        put32(offsetBytes, ifdOffset);
+        out.seekp(4);
+        out.write(reinterpret_cast<const char*>(offsetBytes.data()), 4);
+        out.close();
+        return rowsWritten == imageHeight && !out.fail();
+    }
+
+private:
+    cv::Mat rgb;
+    uint32_t rowBytes = 0;
+    uint32_t rowsPerStrip = 1;
+};
+
+std::unique_ptr<StripWriter> StripWriter::create(const std::string& path, int width, int height,
+                                                 std::string& error)
+{
+    std::string ext = lowerExtension(path);
+    std::unique_ptr<StripWriter> writer;
+    bool ok = false;
+
+    if (ext == "png") {
+        std::unique_ptr<PngStripWriter> png(new PngStripWriter);
+        png->imageWidth = width;
+        png->imageHeight = height;
+        png->out.open(path, std::ios::binary);
+        ok = png->out && png->begin();
+        writer = std::move(png);
+    } else if (ext == "tif" || ext == "tiff") {
+        if (static_cast<uint64_t>(width) * height * 3 > 0xFFFFFFF0ull) {
+            error = "Imaginea depaseste 4 GB; folositi .png sau .ppm";
+            return nullptr;
+        }
+        std::unique_ptr<TiffStripWriter> tiff(new TiffStripWriter);
+        tiff->imageWidth = width;
+        tiff->imageHeight = height;
+        tiff->out.open(path, std::ios::binary);
+        ok = tiff->out && tiff->begin();
+        writer = std::move(tiff);
+    } else if (ext == "ppm") {
+        std::unique_ptr<PnmStripWriter> pnm(new PnmStripWriter);
+        pnm->imageWidth = width;
+        pnm->imageHeight = height;
+        pnm->out.open(path, std::ios::binary);
+        ok = pnm->out && pnm->begin();
+        writer = std::move(pnm);
+    } else {
+        error = "Format de iesire nesuportat pentru streaming (folositi .png, .tif sau .ppm)";
+        return nullptr;
+    }
+
+    if (!ok) {
+        error = "Nu s-a putut scrie " + path;
+        return nullptr;
+    }
+    return writer;
+}
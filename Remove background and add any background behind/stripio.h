@@ -0,0 +1,57 @@
+#ifndef STRIPIO_H
+#define STRIPIO_H
+
+#include <opencv2/opencv.hpp>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Citeste imaginea de sus in jos, cate o banda orizontala, fara sa o incarce toata.
+// PPM/PGM binar si TIFF necomprimat sunt citite direct de pe disc; celelalte formate
+// trec prin cv::imread si nu au memoria limitata.
+class StripReader {
+public:
+    virtual ~StripReader() = default;
+
+    static std::unique_ptr<StripReader> open(const std::string& path, std::string& error);
+
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    int nextRow() const { return currentRow; }
+    virtual bool isStreaming() const { return true; }
+
+    // Umple strip (CV_8UC3, BGR) cu urmatoarele cel mult maxRows randuri.
+    virtual bool read(int maxRows, cv::Mat& strip) = 0;
+
+protected:
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int currentRow = 0;
+};
+
+// Scrie randurile pe masura ce sosesc; nimic nu ramane in memorie dupa write().
+// "Edit image" (stripwriter.cpp) are o copie a scrierii PNG/TIFF, iar "Detects and counts
+// objects in the image" (stripreader.cpp) una a citirii; aplicatiile se compileaza separat,
+// deci o corectura la una dintre ele trebuie facuta in toate.
+class StripWriter {
+public:
+    virtual ~StripWriter() = default;
+
+    // Formatul se alege dupa extensie: .png, .tif/.tiff, .ppm
+    static std::unique_ptr<StripWriter> create(const std::string& path, int width, int height,
+                                               std::string& error);
+
+    // strip este CV_8UC3, BGR, cu latimea imaginii.
+    virtual bool write(const cv::Mat& strip) = 0;
+    virtual bool finish() = 0;
+
+protected:
+    std::ofstream out;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int rowsWritten = 0;
+    std::vector<unsigned char> rowBuffer;
+};
+
+#endif
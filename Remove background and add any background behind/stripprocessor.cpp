@@ -0,0 +1,110 @@
+#include "stripprocessor.h"
+#include "backgroundreplace.h"
+#include "stripio.h"
+#include <QDebug>
+
+// Octeti tinuti in memorie pentru fiecare pixel al unei benzi: citire + gri + masca +
+// fundal + rezultat + conversia RGB si bufferul encoderului + hartile pentru remap.
+static const size_t kBytesPerStripPixel = 4 + 3 + 1 + 1 + 3 + 3 + 3 + 3 + 3 + 8;
+
+StripProcessor::StripProcessor(const StripSettings& settings)
+    : settings(settings)
+    , rowsPerStrip(0)
+    , estimatedPeak(0)
+{
+}
+
+bool StripProcessor::run()
+{
+    std::unique_ptr<StripReader> reader = StripReader::open(settings.inputPath, error);
+    if (!reader) return false;
+
+    if (!reader->isStreaming()) {
+        qWarning() << "Formatul de intrare nu poate fi citit pe benzi; imaginea se incarca intreaga."
+                   << "Folositi TIFF necomprimat sau PPM pentru memorie limitata.";
+    }
+
+    if (!settings.backgroundPath.empty()) {
+        backgroundSource = cv::imread(settings.backgroundPath);
+        if (backgroundSource.empty()) {
+            error = "Nu s-a putut incarca imaginea de fundal " + settings.backgroundPath;
+            return false;
+        }
+    }
+
+    const int width = reader->width();
+    const int height = reader->height();
+    size_t fixedBytes = backgroundSource.total() * backgroundSource.elemSize();
+    if (!reader->isStreaming()) {
+        fixedBytes += static_cast<size_t>(width) * height * 3;
+    }
+
+    rowsPerStrip = computeStripRows(width, fixedBytes);
+    if (rowsPerStrip <= 0) {
+        error = "Bugetul de memorie este prea mic pentru un singur rand al imaginii";
+        return false;
+    }
+    estimatedPeak = fixedBytes + static_cast<size_t>(rowsPerStrip) * width * kBytesPerStripPixel;
+
+    std::unique_ptr<StripWriter> writer = StripWriter::create(settings.outputPath, width, height, error);
+    if (!writer) return false;
+
+    cv::Mat strip, background, result;
+    while (reader->nextRow() < height) {
+        int firstRow = reader->nextRow();
+        if (!reader->read(rowsPerStrip, strip)) {
+            error = "Eroare la citirea randului " + std::to_string(firstRow);
+            return false;
+        }
+
+        backgroundStrip(firstRow, strip.rows, width, height, background);
+        replaceBackground(strip, background, settings.backgroundColor, settings.thresholdValue, result);
+
+        if (!writer->write(result)) {
+            error = "Eroare la scrierea in " + settings.outputPath;
+            return false;
+        }
+    }
+
+    if (!writer->finish()) {
+        error = "Eroare la finalizarea fisierului " + settings.outputPath;
+        return false;
+    }
+    return true;
+}
+
+int StripProcessor::computeStripRows(int width, size_t fixedBytes) const
+{
+    if (settings.memoryBudget <= fixedBytes) return 0;
+
+    size_t rowBytes = static_cast<size_t>(width) * kBytesPerStripPixel;
+    size_t rows = (settings.memoryBudget - fixedBytes) / rowBytes;
+    return static_cast<int>(std::min<size_t>(rows, 4096));
+}
+
+// Echivalentul benzii [firstRow, firstRow + rows) din cv::resize(backgroundSource, ..., {width, height}),
+// calculat fara sa existe vreodata fundalul intreg la rezolutia de iesire.
+void StripProcessor::backgroundStrip(int firstRow, int rows, int width, int height, cv::Mat& strip)
+{
+    if (backgroundSource.empty()) {
+        strip.release();
+        return;
+    }
+
+    const float scaleX = static_cast<float>(backgroundSource.cols) / width;
+    const float scaleY = static_cast<float>(backgroundSource.rows) / height;
+
+    mapX.create(rows, width, CV_32FC1);
+    mapY.create(rows, width, CV_32FC1);
+    for (int y = 0; y < rows; ++y) {
+        float* mx = mapX.ptr<float>(y);
+        float* my = mapY.ptr<float>(y);
+        float sourceY = std::max(0.f, (firstRow + y + 0.5f) * scaleY - 0.5f);
+        for (int x = 0; x < width; ++x) {
+            mx[x] = std::max(0.f, (x + 0.5f) * scaleX - 0.5f);
+            my[x] = sourceY;
+        }
+    }
+
+    cv::remap(backgroundSource, strip, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+}
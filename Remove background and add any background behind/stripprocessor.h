@@ -0,0 +1,41 @@
+#ifndef STRIPPROCESSOR_H
+#define STRIPPROCESSOR_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+struct StripSettings {
+    std::string inputPath;
+    std::string outputPath;
+    std::string backgroundPath;
+    cv::Scalar backgroundColor = cv::Scalar(255, 255, 255);
+    int thresholdValue = 128;
+    size_t memoryBudget = 256u * 1024u * 1024u;
+};
+
+// Aceeasi prelucrare ca MainWindow::updateImage (gri -> prag -> fundal nou), dar pe benzi
+// orizontale citite si scrise direct pe disc, ca sa ramana in bugetul de memorie dat.
+class StripProcessor {
+public:
+    explicit StripProcessor(const StripSettings& settings);
+
+    bool run();
+
+    const std::string& errorString() const { return error; }
+    int stripRows() const { return rowsPerStrip; }
+    size_t peakBytes() const { return estimatedPeak; }
+
+private:
+    int computeStripRows(int width, size_t fixedBytes) const;
+    void backgroundStrip(int firstRow, int rows, int width, int height, cv::Mat& strip);
+
+    StripSettings settings;
+    std::string error;
+    cv::Mat backgroundSource;
+    cv::Mat mapX;
+    cv::Mat mapY;
+    int rowsPerStrip;
+    size_t estimatedPeak;
+};
+
+#endif